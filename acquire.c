@@ -0,0 +1,352 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "acquire.h"
+
+#define ACQUIRE_PIO pio0
+#define ACQUIRE_PIO_BLOCK_IRQ 0  // Raised by the snapshot state machine, starts the ADC sequencer
+
+// Filled by DMA only
+static volatile uint16_t adc_ring[ACQUIRE_RING_BLOCKS * ACQUIRE_ADC_MAX];
+static volatile uint32_t gpio_ring[ACQUIRE_RING_BLOCKS];
+
+// Sequencer entries, built from the channel table (see build_entries())
+static uint32_t entries[ACQUIRE_ADC_MAX];
+static uint8_t adc_count;
+static uint32_t scan_cycles;   // Sequencer cycles per block
+
+// Values the reload channels write back into the data channels. Kept in RAM, not flash: DMA cannot
+// read through XIP while a flash write is in progress.
+static volatile uint16_t *adc_ring_start = adc_ring;
+static volatile uint32_t *gpio_ring_start = gpio_ring;
+static uint32_t *entries_start = entries;
+static uint32_t entries_count;
+static uint32_t trigger_count = ACQUIRE_RING_BLOCKS;
+static uint32_t trigger_token;
+
+static int adc_chan = -1;
+static int gpio_chan = -1;
+static uint snapshot_sm;
+static uint sequencer_sm;
+
+//----------------------- PIO Button Snapshot -----------------------//
+// Waits for a token from the trigger channel, shifts all 32 GPIO inputs into the ISR in one
+// instruction (autopush hands the word to the RX FIFO) and starts the ADC sequencer.
+static uint16_t snapshot_instructions[3];
+static const pio_program_t snapshot_program = { snapshot_instructions, 3, -1 };
+
+static void snapshot_start(void)
+{
+  snapshot_instructions[0] = (uint16_t) pio_encode_pull(false, true);                  // pull block
+  snapshot_instructions[1] = (uint16_t) pio_encode_in(pio_pins, 32);                   // in pins, 32
+  snapshot_instructions[2] = (uint16_t) pio_encode_irq_set(false, ACQUIRE_PIO_BLOCK_IRQ);  // irq nowait 0
+
+  uint const offset = pio_add_program(ACQUIRE_PIO, &snapshot_program);
+  snapshot_sm = (uint) pio_claim_unused_sm(ACQUIRE_PIO, true);
+
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, offset, offset + 2);
+  sm_config_set_in_pins(&c, 0);
+  sm_config_set_in_shift(&c, false, true, 32);  // Autopush every full word
+  pio_sm_init(ACQUIRE_PIO, snapshot_sm, offset, &c);
+}
+
+//----------------------- PIO ADC Sequencer -----------------------//
+// Entry word, one per channel table entry:
+//   bits  0-15  ADC CS word: enable, temperature sensor enable, START_ONCE, AINSEL
+//   bits 16-19  mux select driven after the conversion has started (the next mux channel)
+//   bit     20  last entry of the block
+//   bits 21-31  wait loop count: until the conversion is done and the next mux channel has settled
+//
+// Timeline of one entry, in system clock cycles from the push that starts the conversion:
+//   0      push: the start channel writes the CS word, the ADC samples
+//   33     out pins: switch the mux while the ADC converts
+//   40+x   push of the next entry
+#define SEQ_ENTRY_CYCLES       40  // Cycles per entry besides the wait loop count
+#define SEQ_SWITCH_TO_START    7   // Cycles from the mux switch to the next push, besides the wait loop count
+#define SEQ_START_LATENCY      8   // DMA write and ADC start synchronisation
+#define SEQ_WAIT_MAX           2047
+#define ADC_CONVERSION_CYCLES  96  // ADC clock cycles per conversion
+
+static uint16_t sequencer_instructions[10];
+static const pio_program_t sequencer_program = { sequencer_instructions, 10, -1 };
+
+static void sequencer_start(void)
+{
+  sequencer_instructions[0] = (uint16_t) pio_encode_wait_irq(true, false, ACQUIRE_PIO_BLOCK_IRQ);  // wait 1 irq 0
+  sequencer_instructions[1] = (uint16_t) pio_encode_pull(false, true);                    // entry: pull block
+  sequencer_instructions[2] = (uint16_t) pio_encode_in(pio_osr, 16);                      // in osr, 16
+  sequencer_instructions[3] = (uint16_t) (pio_encode_push(false, true) | pio_encode_delay(31));  // push block [31]
+  sequencer_instructions[4] = (uint16_t) pio_encode_out(pio_null, 16);                    // out null, 16
+  sequencer_instructions[5] = (uint16_t) pio_encode_out(pio_pins, ACQUIRE_MUX_SELECT_PINS);  // out pins, 4
+  sequencer_instructions[6] = (uint16_t) pio_encode_out(pio_y, 1);                        // out y, 1
+  sequencer_instructions[7] = (uint16_t) pio_encode_out(pio_x, 11);                       // out x, 11
+  sequencer_instructions[8] = (uint16_t) pio_encode_jmp_x_dec(8);                         // wait: jmp x-- wait
+  sequencer_instructions[9] = (uint16_t) pio_encode_jmp_not_y(1);                         // jmp !y entry
+
+  uint const offset = pio_add_program(ACQUIRE_PIO, &sequencer_program);
+  sequencer_sm = (uint) pio_claim_unused_sm(ACQUIRE_PIO, true);
+
+  for (uint i = 0; i < ACQUIRE_MUX_SELECT_PINS; i++) pio_gpio_init(ACQUIRE_PIO, ACQUIRE_MUX_SELECT_PIN_BASE + i);
+  pio_sm_set_consecutive_pindirs(ACQUIRE_PIO, sequencer_sm, ACQUIRE_MUX_SELECT_PIN_BASE, ACQUIRE_MUX_SELECT_PINS, true);
+
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, offset, offset + 9);
+  sm_config_set_out_pins(&c, ACQUIRE_MUX_SELECT_PIN_BASE, ACQUIRE_MUX_SELECT_PINS);
+  sm_config_set_in_shift(&c, false, false, 32);   // CS word lands in ISR[15:0]
+  sm_config_set_out_shift(&c, true, false, 32);   // Entry fields from bit 0 up
+  pio_sm_init(ACQUIRE_PIO, sequencer_sm, offset, &c);
+}
+
+// Every entry drives the select lines for the next mux channel in the table, so the mux switches as
+// soon as the ADC has sampled and settles while the ADC converts (and during any direct inputs in
+// between). The wait loop covers whichever is longer: the conversion or the next channel's settle time.
+static void build_entries(const acquire_channel *channels, uint8_t count)
+{
+  uint32_t const sys_hz = clock_get_hz(clk_sys);
+  uint32_t const conversion = (uint32_t) ((uint64_t) ADC_CONVERSION_CYCLES * sys_hz / clock_get_hz(clk_adc)) + 1;
+
+  scan_cycles = 0;
+  for (uint8_t k = 0; k < count; k++)
+  {
+    const acquire_channel *next = &channels[(k + 1) % count];
+
+    uint8_t select = channels[k].mux_select;
+    for (uint8_t j = 1; j <= count; j++)
+    {
+      const acquire_channel *c = &channels[(k + j) % count];
+      if (c->adc_input == ACQUIRE_MUX_ADC_INPUT) { select = c->mux_select; break; }
+    }
+
+    uint32_t wait = conversion + SEQ_START_LATENCY > SEQ_ENTRY_CYCLES ? conversion + SEQ_START_LATENCY - SEQ_ENTRY_CYCLES : 0;
+    if (next->adc_input == ACQUIRE_MUX_ADC_INPUT)
+    {
+      uint32_t const settle = (uint32_t) ((uint64_t) next->settle_ns * sys_hz / 1000000000u);
+      if (settle > wait + SEQ_SWITCH_TO_START) wait = settle - SEQ_SWITCH_TO_START;
+    }
+    if (wait > SEQ_WAIT_MAX) wait = SEQ_WAIT_MAX;
+
+    uint32_t const cs = ADC_CS_EN_BITS | ADC_CS_TS_EN_BITS | ADC_CS_START_ONCE_BITS |
+                        ((uint32_t) channels[k].adc_input << ADC_CS_AINSEL_LSB);
+    entries[k] = cs | (uint32_t) (select & 0xF) << 16 | (uint32_t) (k == count - 1) << 20 | wait << 21;
+    scan_cycles += SEQ_ENTRY_CYCLES + wait;
+  }
+}
+
+//----------------------- Ring Channels -----------------------//
+// Starts data channel `data` with config `c` and chains it to a new reload channel, which writes
+// *restart_value into `restart_reg` (a trigger alias of `data`) when the ring is complete
+static void ring_start(int data, dma_channel_config *c, volatile void *write, const volatile void *read,
+                       uint32_t count, volatile uint32_t *restart_reg, const volatile void *restart_value)
+{
+  int const reload = dma_claim_unused_channel(true);
+  dma_channel_config rc = dma_channel_get_default_config(reload);
+  channel_config_set_transfer_data_size(&rc, DMA_SIZE_32);
+  channel_config_set_read_increment(&rc, false);
+  channel_config_set_write_increment(&rc, false);
+  dma_channel_configure(reload, &rc, restart_reg, restart_value, 1, false);
+
+  channel_config_set_chain_to(c, reload);
+  dma_channel_configure(data, c, write, read, count, true);
+}
+
+// Data channel config: fixed read address, `dreq` paced
+static dma_channel_config channel_config(int chan, enum dma_channel_transfer_size size, bool write_increment, uint dreq)
+{
+  dma_channel_config c = dma_channel_get_default_config(chan);
+  channel_config_set_transfer_data_size(&c, size);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, write_increment);
+  channel_config_set_dreq(&c, dreq);
+  return c;
+}
+
+// ADC FIFO into the ADC ring
+static void adc_dma_start(void)
+{
+  adc_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = channel_config(adc_chan, DMA_SIZE_16, true, DREQ_ADC);
+  ring_start(adc_chan, &c, adc_ring, &adc_hw->fifo, ACQUIRE_RING_BLOCKS * adc_count,
+             &dma_hw->ch[adc_chan].al2_write_addr_trig, &adc_ring_start);
+}
+
+// Sequencer RX FIFO into the ADC CS register (starts a conversion), and entries into its TX FIFO
+static void sequencer_dma_start(void)
+{
+  int const start_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = channel_config(start_chan, DMA_SIZE_32, false, pio_get_dreq(ACQUIRE_PIO, sequencer_sm, false));
+  ring_start(start_chan, &c, &adc_hw->cs, &ACQUIRE_PIO->rxf[sequencer_sm], entries_count,
+             &dma_hw->ch[start_chan].al1_transfer_count_trig, &entries_count);
+
+  int const entry_chan = dma_claim_unused_channel(true);
+  c = channel_config(entry_chan, DMA_SIZE_32, false, pio_get_dreq(ACQUIRE_PIO, sequencer_sm, true));
+  channel_config_set_read_increment(&c, true);
+  ring_start(entry_chan, &c, &ACQUIRE_PIO->txf[sequencer_sm], entries, entries_count,
+             &dma_hw->ch[entry_chan].al3_read_addr_trig, &entries_start);
+}
+
+// Snapshot RX FIFO into the GPIO ring
+static void gpio_dma_start(void)
+{
+  gpio_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = channel_config(gpio_chan, DMA_SIZE_32, true, pio_get_dreq(ACQUIRE_PIO, snapshot_sm, false));
+  ring_start(gpio_chan, &c, gpio_ring, &ACQUIRE_PIO->rxf[snapshot_sm], ACQUIRE_RING_BLOCKS,
+             &dma_hw->ch[gpio_chan].al2_write_addr_trig, &gpio_ring_start);
+}
+
+// One token into the snapshot state machine per DMA timer tick
+static void trigger_dma_start(uint timer)
+{
+  int const trigger_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = channel_config(trigger_chan, DMA_SIZE_32, false, dma_get_timer_dreq(timer));
+  ring_start(trigger_chan, &c, &ACQUIRE_PIO->txf[snapshot_sm], &trigger_token, ACQUIRE_RING_BLOCKS,
+             &dma_hw->ch[trigger_chan].al1_transfer_count_trig, &trigger_count);
+}
+
+// Values written into the current pass over each ring
+static uint32_t adc_written(void)
+{
+  return (dma_hw->ch[adc_chan].write_addr - (uint32_t) (uintptr_t) adc_ring) / sizeof(uint16_t);
+}
+
+static uint32_t gpio_written(void)
+{
+  return (dma_hw->ch[gpio_chan].write_addr - (uint32_t) (uintptr_t) gpio_ring) / sizeof(uint32_t);
+}
+
+// Blocks are paced by a DMA timer from the same crystal as the microsecond timer, so every block's
+// capture time follows from the first one (to within the DMA write of the block, a few us)
+#define ACQUIRE_BLOCK_US (1000000 / ACQUIRE_BLOCK_HZ)
+
+static uint32_t first_block_us;
+
+uint32_t acquire_block_us(void)
+{
+  uint32_t const since = time_us_32() - first_block_us;
+  return first_block_us + since - since % ACQUIRE_BLOCK_US;
+}
+
+// Newest complete block given the number of complete blocks in the current pass; right after a
+// restart that is the last block of the previous pass
+static uint32_t newest_block(uint32_t complete)
+{
+  return (complete ? complete : ACQUIRE_RING_BLOCKS) - 1;
+}
+
+void acquire_start(const acquire_channel *channels, uint8_t count)
+{
+  adc_count = count < ACQUIRE_ADC_MAX ? count : ACQUIRE_ADC_MAX;
+  entries_count = adc_count;
+  build_entries(channels, adc_count);
+
+  // Conversions are started one at a time by the sequencer
+  adc_run(false);
+  adc_set_round_robin(0);
+  adc_fifo_setup(true, true, 1, false, false);
+  adc_fifo_drain();
+
+  snapshot_start();
+  sequencer_start();
+  adc_dma_start();
+  sequencer_dma_start();
+  gpio_dma_start();
+  pio_sm_set_enabled(ACQUIRE_PIO, sequencer_sm, true);
+  pio_sm_set_enabled(ACQUIRE_PIO, snapshot_sm, true);
+
+  uint const timer = (uint) dma_claim_unused_timer(true);
+  trigger_dma_start(timer);
+  dma_timer_set_fraction(timer, 1, (uint16_t) (clock_get_hz(clk_sys) / ACQUIRE_BLOCK_HZ));
+
+  while (adc_written() < adc_count || gpio_written() < 1)
+  {
+    tight_loop_contents();
+  }
+  first_block_us = time_us_32();
+}
+
+uint8_t acquire_adc_latest(uint16_t *adc)
+{
+  uint32_t const block = newest_block(adc_written() / adc_count);
+  volatile uint16_t const *src = &adc_ring[block * adc_count];
+  for (uint8_t i = 0; i < adc_count; i++) adc[i] = src[i];
+  return (uint8_t) block;
+}
+
+void acquire_gpio_window(uint8_t count, uint32_t *all_high, uint32_t *all_low)
+{
+  uint32_t const newest = newest_block(gpio_written());
+  uint32_t high = ~0u, low = ~0u;
+
+  if (count > ACQUIRE_RING_BLOCKS) count = ACQUIRE_RING_BLOCKS;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint32_t const w = gpio_ring[(newest + ACQUIRE_RING_BLOCKS - i) % ACQUIRE_RING_BLOCKS];
+    high &= w;
+    low &= ~w;
+  }
+  *all_high = high;
+  *all_low = low;
+}
+
+uint32_t acquire_gpio_edge_us(uint32_t pins)
+{
+  uint32_t const block_us = acquire_block_us();
+  uint32_t const newest = newest_block(gpio_written());
+  uint32_t const level = gpio_ring[newest] & pins;
+
+  uint32_t age = 1;
+  while (age < ACQUIRE_RING_BLOCKS &&
+         (gpio_ring[(newest + ACQUIRE_RING_BLOCKS - age) % ACQUIRE_RING_BLOCKS] & pins) == level)
+  {
+    age++;
+  }
+  return block_us - (age - 1) * ACQUIRE_BLOCK_US;
+}
+
+// Telemetry page: u16 block rate (Hz), u8 ring blocks, u8 ADC entries, u8 ADC block, u8 GPIO block,
+// u32 newest GPIO snapshot, u32 ADC scan time per block (ns)
+uint16_t acquire_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 14 || adc_chan < 0) return 0;
+
+  uint16_t const rate = ACQUIRE_BLOCK_HZ;
+  uint32_t const gpio = gpio_ring[newest_block(gpio_written())];
+  uint32_t const scan_ns = (uint32_t) ((uint64_t) scan_cycles * 1000000000u / clock_get_hz(clk_sys));
+
+  memcpy(&buf[0], &rate, 2);
+  buf[2] = ACQUIRE_RING_BLOCKS;
+  buf[3] = adc_count;
+  buf[4] = (uint8_t) newest_block(adc_written() / adc_count);
+  buf[5] = (uint8_t) newest_block(gpio_written());
+  memcpy(&buf[6], &gpio, 4);
+  memcpy(&buf[10], &scan_ns, 4);
+  return 14;
+}
@@ -0,0 +1,90 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef ACQUIRE_H_
+#define ACQUIRE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- DMA Input Acquisition -----------------------//
+// Samples the analog inputs and the button GPIOs without the CPU. Each block holds one sample of
+// every input; the hardware keeps a ring of ACQUIRE_RING_BLOCKS blocks filled:
+//
+//   trigger  a DMA timer paces a channel that writes one token per block into the snapshot state
+//            machine (PIO)
+//   buttons  the snapshot state machine shifts GPIO 0-31 into its RX FIFO in one cycle, a DMA channel
+//            stores the word, and PIO IRQ 0 starts the ADC sequencer for the same block
+//   ADC      the sequencer state machine walks the channel table: for each entry it hands the entry's
+//            ADC CS word to a DMA channel, which starts the conversion, then switches the analog mux
+//            to the next mux channel while this one converts, and waits out the settle time. A DMA
+//            channel drains the ADC FIFO into the ADC ring.
+//
+// Each data channel is chained to a reload channel that points it back at the start of its ring (or
+// table), so everything advances forever without the CPU, also while the CPU is stalled by a flash
+// write. The CPU only reads the newest complete block when it needs it (at report time).
+//
+// Analog mux (4051/4067 class): the select lines are ACQUIRE_MUX_SELECT_PINS consecutive GPIOs from
+// ACQUIRE_MUX_SELECT_PIN_BASE. Because the mux is switched right after the ADC has sampled the previous
+// channel, settle times up to one conversion (2 us) cost nothing; 16 mux channels scan in about 33 us.
+#define ACQUIRE_BLOCK_HZ            8000  // Blocks per second: 8 button samples per 1 ms debounce window
+#define ACQUIRE_RING_BLOCKS         32    // 4 ms of history
+#define ACQUIRE_ADC_MAX             20    // Channel table entries (conversions per block)
+#define ACQUIRE_MUX_SELECT_PIN_BASE 10    // GPIO 10-13: mux S0-S3
+#define ACQUIRE_MUX_SELECT_PINS     4
+#define ACQUIRE_MUX_ADC_INPUT       2     // Mux output on ADC2 (GPIO 28)
+
+// One conversion per block. `mux_select` only matters for the ADC input the mux output is wired to;
+// `settle_ns` is how long the mux output needs after switching to this channel.
+typedef struct
+{
+  uint8_t adc_input;    // ADC input 0-4 (4 = temperature sensor)
+  uint8_t mux_select;   // Mux channel, driven on the select lines before the conversion
+  uint16_t settle_ns;   // Settle time after switching the mux to this channel, 0 for direct inputs
+} acquire_channel;
+
+// Start the DMA channels, the PIO state machines and the ADC; returns once the first block is
+// complete. The ADC and the temperature sensor must already be initialised. The table is copied and
+// must fit in one block period (see acquire_telemetry() for the resulting scan time).
+void acquire_start(const acquire_channel *channels, uint8_t count);
+
+// Copies the newest complete ADC block (one value per channel table entry) and returns its ring
+// index, which moves on with every new block
+uint8_t acquire_adc_latest(uint16_t *adc);
+
+// GPIO 0-31 over the newest `count` button blocks (at most ACQUIRE_RING_BLOCKS): bits that read high
+// in all of them and bits that read low in all of them
+void acquire_gpio_window(uint8_t count, uint32_t *all_high, uint32_t *all_low);
+
+// Capture time (time_us_32()) of the newest complete block
+uint32_t acquire_block_us(void);
+
+// Capture time of the oldest block in the newest run where all `pins` read as in the newest block,
+// i.e. when their last change was first sampled; at most ACQUIRE_RING_BLOCKS back
+uint32_t acquire_gpio_edge_us(uint32_t pins);
+
+uint16_t acquire_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* ACQUIRE_H_ */
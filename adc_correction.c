@@ -0,0 +1,181 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "flash_layout.h"
+#include "flash_store.h"
+#include "crc32.h"
+#include "adc_correction.h"
+
+// Flash format: one header page, followed by ADC_CODES int8 deltas
+#define ADC_LUT_MAGIC        0xADC1u
+#define ADC_LUT_DELTA_OFFSET (FLASH_ADC_LUT_OFFSET + FLASH_PAGE_SIZE)
+
+typedef struct
+{
+  uint16_t magic;
+  uint16_t count;   // ADC_CODES
+  uint32_t crc;     // CRC-32 of the deltas
+} adc_lut_header;
+
+uint16_t adc_lut[ADC_CODES];
+static adc_lut_source lut_source = ADC_LUT_IDENTITY;  // Nothing reads the table before adc_correction_init()
+
+// Upload state
+static uint16_t next_offset = 0;
+static uint8_t page[FLASH_PAGE_SIZE];
+
+static uint16_t clamp_code(int32_t v)
+{
+  if (v < 0) return 0;
+  if (v > ADC_CODES - 1) return ADC_CODES - 1;
+  return (uint16_t) v;
+}
+
+// Errata model: the four spike codes are ADC_ERRATA_DNL_LSB wider than a normal code and the rest
+// are narrower by the same total, so the full scale still spans 4096 codes. Each code maps to the
+// centre of the input range that produces it (Q16 fixed point).
+static void build_errata_lut(void)
+{
+  int32_t const spike = ADC_ERRATA_DNL_LSB << 16;
+  int32_t const normal = 65536 - ADC_ERRATA_DNL_LSB * 64;  // 1 - 4 * E / 4096
+  int32_t edge = 0;
+
+  for (int32_t code = 0; code < ADC_CODES; code++)
+  {
+    int32_t width = normal;
+    if ((code & 0x3FF) == 0x200) width += spike;  // 512, 1536, 2560, 3584
+
+    int32_t const centre = edge + width / 2 - (1 << 15);
+    adc_lut[code] = clamp_code((centre + (1 << 15)) >> 16);
+    edge += width;
+  }
+  lut_source = ADC_LUT_ERRATA;
+}
+
+static bool load_factory_lut(void)
+{
+  const adc_lut_header *hdr = flash_store_ptr(FLASH_ADC_LUT_OFFSET);
+  const int8_t *deltas = flash_store_ptr(ADC_LUT_DELTA_OFFSET);
+
+  if (hdr->magic != ADC_LUT_MAGIC || hdr->count != ADC_CODES) return false;
+  if (crc32_update(0, deltas, ADC_CODES) != hdr->crc) return false;
+
+  for (int32_t code = 0; code < ADC_CODES; code++)
+  {
+    adc_lut[code] = clamp_code(code + deltas[code]);
+  }
+  lut_source = ADC_LUT_FACTORY;
+  return true;
+}
+
+// Build the SRAM table. Called once, lazily, when the ADC is brought up.
+void adc_correction_init(void)
+{
+  if (!load_factory_lut()) build_errata_lut();
+}
+
+adc_lut_source adc_correction_source(void)
+{
+  return lut_source;
+}
+
+// Raw capture for the factory sweep: pass every code through unchanged until switched back
+void adc_correction_raw(bool raw)
+{
+  if (raw)
+  {
+    for (int32_t code = 0; code < ADC_CODES; code++)
+    {
+      adc_lut[code] = (uint16_t) code;
+    }
+    lut_source = ADC_LUT_IDENTITY;
+  }
+  else if (lut_source == ADC_LUT_IDENTITY)
+  {
+    adc_correction_init();
+  }
+}
+
+//----------------------- Factory Upload -----------------------//
+// BEGIN erases the stored table, DATA streams the deltas in order (programmed a flash page at a
+// time), COMMIT checks the CRC of what landed in flash and only then writes the header that makes
+// the table valid. The SRAM table switches over on commit.
+void adc_correction_begin(void)
+{
+  flash_store_erase(FLASH_ADC_LUT_OFFSET, FLASH_ADC_LUT_SIZE);
+  next_offset = 0;
+}
+
+bool adc_correction_write(uint16_t offset, const int8_t *deltas, uint8_t len)
+{
+  if (offset != next_offset || offset + len > ADC_CODES) return false;
+
+  while (len)
+  {
+    uint16_t const in_page = next_offset % FLASH_PAGE_SIZE;
+    uint16_t chunk = FLASH_PAGE_SIZE - in_page;
+    if (chunk > len) chunk = len;
+
+    memcpy(&page[in_page], deltas, chunk);
+    deltas += chunk;
+    len -= chunk;
+    next_offset += chunk;
+
+    if (next_offset % FLASH_PAGE_SIZE == 0)
+    {
+      flash_store_program(ADC_LUT_DELTA_OFFSET + next_offset - FLASH_PAGE_SIZE, page, FLASH_PAGE_SIZE);
+    }
+  }
+  return true;
+}
+
+bool adc_correction_commit(uint32_t crc)
+{
+  if (next_offset != ADC_CODES) return false;
+  if (crc32_update(0, flash_store_ptr(ADC_LUT_DELTA_OFFSET), ADC_CODES) != crc) return false;
+
+  memset(page, 0xFF, sizeof(page));
+  adc_lut_header const hdr = { .magic = ADC_LUT_MAGIC, .count = ADC_CODES, .crc = crc };
+  memcpy(page, &hdr, sizeof(hdr));
+  flash_store_program(FLASH_ADC_LUT_OFFSET, page, FLASH_PAGE_SIZE);
+
+  return load_factory_lut();
+}
+
+// Drop the per-unit table and go back to the errata model
+void adc_correction_clear(void)
+{
+  flash_store_erase(FLASH_ADC_LUT_OFFSET, FLASH_ADC_LUT_SIZE);
+  next_offset = 0;
+  build_errata_lut();
+}
+
+uint16_t adc_correction_next_offset(void)
+{
+  return next_offset;
+}
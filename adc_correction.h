@@ -0,0 +1,71 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef ADC_CORRECTION_H_
+#define ADC_CORRECTION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- ADC Linearity Correction -----------------------//
+// The RP2040 ADC has differential non-linearity spikes: the codes around 512, 1536, 2560 and 3584
+// are several LSB wide, which shows up as steps and sticky spots on the sticks. Every raw sample is
+// mapped through a 4096 entry table in SRAM, one load per sample, before any other conditioning.
+//
+// The table comes from a per-unit correction measured at the factory station and stored in flash
+// (tools/adc_lut_builder.py), or, for units without one, from a fixed model of the published errata.
+// The flash copy stores one signed delta per code: corrected = raw + delta[raw].
+//
+// For measuring that correction the table can be switched to identity, so the mux channels (telemetry
+// MUX page) carry the uncorrected codes of a sweep; any table change switches it back.
+#define ADC_CODES           4096
+#define ADC_ERRATA_DNL_LSB  8      // Extra width of each spike code in the errata model
+
+typedef enum
+{
+  ADC_LUT_IDENTITY = 0,  // No correction: raw codes pass through, for capturing a sweep
+  ADC_LUT_ERRATA,        // Fixed errata model
+  ADC_LUT_FACTORY,       // Per-unit table from flash
+} adc_lut_source;
+
+extern uint16_t adc_lut[ADC_CODES];
+
+static inline uint16_t adc_correct(uint16_t raw)
+{
+  return adc_lut[raw & (ADC_CODES - 1)];
+}
+
+void adc_correction_init(void);
+adc_lut_source adc_correction_source(void);
+
+// Factory upload of a per-unit table (driven by calibration.c)
+void adc_correction_begin(void);
+bool adc_correction_write(uint16_t offset, const int8_t *deltas, uint8_t len);
+bool adc_correction_commit(uint32_t crc);
+void adc_correction_clear(void);
+void adc_correction_raw(bool raw);
+uint16_t adc_correction_next_offset(void);
+
+#endif /* ADC_CORRECTION_H_ */
@@ -0,0 +1,138 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "axis_health.h"
+
+typedef struct
+{
+  uint16_t min, max;
+  uint16_t prev, prev2;     // Last two samples, for spike detection
+  uint32_t spikes;
+
+  // Welford state of the current rest window, 12.4 fixed point
+  uint16_t n;
+  int32_t mean_q4;
+  int32_t m2_q8;
+
+  // Completed windows; variances in codes^2, 8.8 fixed point
+  uint16_t var_q8;
+  uint16_t var_max_q8;
+  uint16_t noise_floor_q8;
+  uint32_t windows;
+} axis_health;
+
+static axis_health health[AXIS_HEALTH_AXIS_COUNT];
+static uint32_t samples;
+
+// Called from the main loop, like axis_health_sample()
+void axis_health_reset(void)
+{
+  memset(health, 0, sizeof(health));
+  samples = 0;
+}
+
+static void window_done(axis_health *h)
+{
+  uint32_t var = (uint32_t) h->m2_q8 / (h->n - 1);
+  if (var > UINT16_MAX) var = UINT16_MAX;
+
+  h->var_q8 = (uint16_t) var;
+  if (h->var_q8 > h->var_max_q8) h->var_max_q8 = h->var_q8;
+
+  if (h->windows == 0 || h->var_q8 < h->noise_floor_q8) h->noise_floor_q8 = h->var_q8;
+  else h->noise_floor_q8 += (h->var_q8 - h->noise_floor_q8 + (1 << AXIS_HEALTH_FLOOR_RISE) - 1) >> AXIS_HEALTH_FLOOR_RISE;
+
+  h->windows++;
+  h->n = 0;
+}
+
+void axis_health_sample(const uint16_t *raw, bool at_rest)
+{
+  for (int i = 0; i < AXIS_HEALTH_AXIS_COUNT; i++)
+  {
+    axis_health *h = &health[i];
+    uint16_t const x = raw[i];
+
+    if (samples == 0)
+    {
+      h->min = h->max = h->prev = h->prev2 = x;
+    }
+
+    h->min = x < h->min ? x : h->min;
+    h->max = x > h->max ? x : h->max;
+
+    // The previous sample is a spike if it stands out from both of its neighbours the same way
+    int32_t const a = (int32_t) h->prev - h->prev2;
+    int32_t const b = (int32_t) h->prev - x;
+    h->spikes += (a > AXIS_HEALTH_SPIKE_CODES && b > AXIS_HEALTH_SPIKE_CODES) ||
+                 (a < -AXIS_HEALTH_SPIKE_CODES && b < -AXIS_HEALTH_SPIKE_CODES);
+    h->prev2 = h->prev;
+    h->prev = x;
+
+    if (!at_rest)
+    {
+      h->n = 0;  // Only whole windows at rest count
+      continue;
+    }
+
+    int32_t const x_q4 = (int32_t) x << 4;
+    if (h->n++ == 0)
+    {
+      h->mean_q4 = x_q4;
+      h->m2_q8 = 0;
+      continue;
+    }
+    int32_t const delta = x_q4 - h->mean_q4;
+    h->mean_q4 += delta / h->n;
+    h->m2_q8 += delta * (x_q4 - h->mean_q4);
+
+    if (h->n == AXIS_HEALTH_WINDOW) window_done(h);
+  }
+  samples++;
+}
+
+// Telemetry page: u32 samples, then per axis { u16 min, u16 max, u32 spikes, u16 var_q8,
+// u16 var_max_q8, u16 noise_floor_q8, u32 windows }
+uint16_t axis_health_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 4 + AXIS_HEALTH_AXIS_COUNT * 18) return 0;
+
+  memcpy(buf, &samples, 4);
+  uint8_t *p = buf + 4;
+  for (int i = 0; i < AXIS_HEALTH_AXIS_COUNT; i++)
+  {
+    axis_health const *h = &health[i];
+    memcpy(p, &h->min, 2);
+    memcpy(p + 2, &h->max, 2);
+    memcpy(p + 4, &h->spikes, 4);
+    memcpy(p + 8, &h->var_q8, 2);
+    memcpy(p + 10, &h->var_max_q8, 2);
+    memcpy(p + 12, &h->noise_floor_q8, 2);
+    memcpy(p + 14, &h->windows, 4);
+    p += 18;
+  }
+  return (uint16_t) (p - buf);
+}
@@ -0,0 +1,51 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef AXIS_HEALTH_H_
+#define AXIS_HEALTH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Stick Health Statistics -----------------------//
+// Streaming per-axis statistics on the linearised raw samples, for spotting worn sticks before
+// players do. Per sample:
+//   - min / max reached (a worn track stops reaching the ends),
+//   - spikes: one sample more than AXIS_HEALTH_SPIKE_CODES away from both neighbours, in the same
+//     direction (wiper lifting off the track),
+//   - while the stick is at rest (drift.c): Welford mean / variance in 12.4 fixed point over windows
+//     of AXIS_HEALTH_WINDOW samples. The window variance feeds a noise floor that follows drops at
+//     once and rises slowly, so it tracks the quietest the stick gets.
+// Telemetry command TELEMETRY_CMD_HEALTH_RESET starts over, e.g. after a stick is replaced.
+#define AXIS_HEALTH_AXIS_COUNT   2
+#define AXIS_HEALTH_SPIKE_CODES  200
+#define AXIS_HEALTH_WINDOW       64
+#define AXIS_HEALTH_FLOOR_RISE   6     // Noise floor rises by 1/64 of the difference per window
+
+void axis_health_sample(const uint16_t *raw, bool at_rest);
+void axis_health_reset(void);
+uint16_t axis_health_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* AXIS_HEALTH_H_ */
@@ -0,0 +1,122 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "flash_layout.h"
+#include "boot_control.h"
+#include "crc32.h"
+
+static const boot_control_t *copy_at(int index)
+{
+  return (const boot_control_t *) (XIP_BASE + FLASH_BOOT_CONTROL_OFFSET + index * FLASH_SECTOR_SIZE);
+}
+
+static bool copy_valid(const boot_control_t *bc)
+{
+  return bc->magic == BOOT_CONTROL_MAGIC
+      && bc->active_slot < BOOT_SLOT_COUNT
+      && bc->crc == crc32_update(0, bc, offsetof(boot_control_t, crc));
+}
+
+// Index of the newest valid copy, or -1 if neither copy is valid
+static int newest_copy(void)
+{
+  int newest = -1;
+  for (int i = 0; i < FLASH_BOOT_CONTROL_COPIES; i++)
+  {
+    const boot_control_t *bc = copy_at(i);
+    if (copy_valid(bc) && (newest < 0 || (int32_t) (bc->seq - copy_at(newest)->seq) > 0)) newest = i;
+  }
+  return newest;
+}
+
+// Read the current record. Returns false (and a factory default: slot A, confirmed) if flash holds
+// no valid record, e.g. right after the bootloader and slot A were flashed with a debugger.
+bool boot_control_read(boot_control_t *bc)
+{
+  int const newest = newest_copy();
+
+  if (newest < 0)
+  {
+    memset(bc, 0, sizeof(*bc));
+    bc->magic = BOOT_CONTROL_MAGIC;
+    bc->active_slot = BOOT_SLOT_A;
+    return false;
+  }
+
+  memcpy(bc, copy_at(newest), sizeof(*bc));
+  return true;
+}
+
+// Write `bc` as the new newest record (updates seq and crc in place). Runs with interrupts disabled
+// while the flash is busy; the caller is responsible for the watchdog deadline.
+void boot_control_write(boot_control_t *bc)
+{
+  int const newest = newest_copy();
+  int const target = newest < 0 ? 0 : (newest + 1) % FLASH_BOOT_CONTROL_COPIES;
+
+  bc->magic = BOOT_CONTROL_MAGIC;
+  bc->seq = newest < 0 ? 1 : copy_at(newest)->seq + 1;
+  bc->crc = crc32_update(0, bc, offsetof(boot_control_t, crc));
+
+  uint8_t page[FLASH_PAGE_SIZE];
+  memset(page, 0xFF, sizeof(page));
+  memcpy(page, bc, sizeof(*bc));
+
+  uint32_t const offset = FLASH_BOOT_CONTROL_OFFSET + target * FLASH_SECTOR_SIZE;
+  uint32_t const irq = save_and_disable_interrupts();
+  flash_range_erase(offset, FLASH_SECTOR_SIZE);
+  flash_range_program(offset, page, FLASH_PAGE_SIZE);
+  restore_interrupts(irq);
+}
+
+uint32_t boot_slot_offset(uint8_t slot)
+{
+  return slot == BOOT_SLOT_B ? FLASH_SLOT_B_OFFSET : FLASH_SLOT_A_OFFSET;
+}
+
+// Sanity check of a slot's vector table: initial SP inside SRAM, reset handler a Thumb address
+// inside the slot. Catches erased or half-written slots before jumping into them.
+bool boot_slot_vectors_valid(uint8_t slot)
+{
+  uint32_t const base = XIP_BASE + boot_slot_offset(slot);
+  const uint32_t *vectors = (const uint32_t *) (base + FLASH_SLOT_VECTOR_OFFSET);
+
+  uint32_t const sp = vectors[0];
+  uint32_t const reset = vectors[1];
+
+  return sp > SRAM_BASE && sp <= SRAM_BASE + 0x42000u && (sp & 3) == 0
+      && (reset & 1) && reset > base && reset < base + FLASH_SLOT_SIZE;
+}
+
+uint32_t boot_slot_crc(uint8_t slot, uint32_t size)
+{
+  if (size > FLASH_SLOT_SIZE) return 0;
+  return crc32_update(0, (const void *) (XIP_BASE + boot_slot_offset(slot)), size);
+}
@@ -0,0 +1,64 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef BOOT_CONTROL_H_
+#define BOOT_CONTROL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Boot Control -----------------------//
+// Record shared by the bootloader and the application that says which firmware slot to start.
+// Two copies live in consecutive flash sectors; every write goes to the older copy with a higher
+// sequence number, so a power loss during a write always leaves the previous record intact.
+//
+// A freshly installed image starts in trial mode. The bootloader counts trial boots and rolls back
+// to the other slot after BOOT_TRIAL_ATTEMPTS, unless the application confirms a healthy boot first.
+#define BOOT_CONTROL_MAGIC   0xB007C7A1u
+#define BOOT_SLOT_A          0
+#define BOOT_SLOT_B          1
+#define BOOT_SLOT_COUNT      2
+#define BOOT_TRIAL_ATTEMPTS  3
+
+typedef struct
+{
+  uint32_t magic;                       // BOOT_CONTROL_MAGIC
+  uint32_t seq;                         // Incremented on every write, the newest valid copy wins
+  uint8_t  active_slot;                 // Slot the bootloader starts
+  uint8_t  trial;                       // Non-zero until the active slot confirmed a healthy boot
+  uint8_t  attempts;                    // Trial boots so far
+  uint8_t  reserved;
+  uint32_t image_size[BOOT_SLOT_COUNT]; // Bytes of image in each slot (0 = unknown / factory)
+  uint32_t image_crc[BOOT_SLOT_COUNT];  // CRC-32 of each slot's image
+  uint32_t crc;                         // CRC-32 of all preceding fields
+} boot_control_t;
+
+bool boot_control_read(boot_control_t *bc);
+void boot_control_write(boot_control_t *bc);
+uint32_t boot_slot_offset(uint8_t slot);
+bool boot_slot_vectors_valid(uint8_t slot);
+uint32_t boot_slot_crc(uint8_t slot, uint32_t size);
+
+#endif /* BOOT_CONTROL_H_ */
@@ -0,0 +1,82 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "boot_profile.h"
+
+static uint32_t boot_marks[BOOT_MARK_COUNT];  // 0 = not reached yet
+
+static uint32_t mount_count = 0;
+static uint32_t mount_us = 0;            // time_us_32() of the latest mount
+static uint32_t last_mount_gap_us = 0;   // Mount-to-first-report gap of the latest mount
+static uint32_t max_mount_gap_us = 0;    // Worst gap over all mounts
+
+void boot_profile_mark(boot_mark mark)
+{
+  if (boot_marks[mark]) return;
+
+  uint32_t now = time_us_32();
+  boot_marks[mark] = now ? now : 1;
+}
+
+void boot_profile_mounted(void)
+{
+  mount_count++;
+  mount_us = time_us_32();
+}
+
+void boot_profile_first_report(void)
+{
+  last_mount_gap_us = time_us_32() - mount_us;
+  if (last_mount_gap_us > max_mount_gap_us) max_mount_gap_us = last_mount_gap_us;
+}
+
+//----------------------- Telemetry -----------------------//
+// Page layout (little-endian):
+//   u32 mark_us[BOOT_MARK_COUNT], u32 boot_to_mount_us, u32 mount_to_first_report_us,
+//   u32 mount_count, u32 last_mount_gap_us, u32 max_mount_gap_us
+// Derived intervals are 0 until both of their marks have been reached.
+uint16_t boot_profile_telemetry(uint8_t *buf, uint16_t len)
+{
+  uint16_t const need = 4 * (BOOT_MARK_COUNT + 5);
+  if (len < need) return 0;
+
+  memcpy(buf, boot_marks, sizeof(boot_marks));
+
+  uint32_t boot_to_mount = boot_marks[BOOT_MARK_MOUNT];
+  uint32_t mount_to_report = 0;
+  if (boot_marks[BOOT_MARK_MOUNT] && boot_marks[BOOT_MARK_FIRST_REPORT])
+  {
+    mount_to_report = boot_marks[BOOT_MARK_FIRST_REPORT] - boot_marks[BOOT_MARK_MOUNT];
+  }
+
+  memcpy(&buf[4 * BOOT_MARK_COUNT], &boot_to_mount, 4);
+  memcpy(&buf[4 * BOOT_MARK_COUNT + 4], &mount_to_report, 4);
+  memcpy(&buf[4 * BOOT_MARK_COUNT + 8], &mount_count, 4);
+  memcpy(&buf[4 * BOOT_MARK_COUNT + 12], &last_mount_gap_us, 4);
+  memcpy(&buf[4 * BOOT_MARK_COUNT + 16], &max_mount_gap_us, 4);
+  return need;
+}
@@ -0,0 +1,52 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef BOOT_PROFILE_H_
+#define BOOT_PROFILE_H_
+
+#include <stdint.h>
+
+//----------------------- Boot Profile -----------------------//
+// Timestamps (time_us_32, microseconds since reset) of the milestones between power-on and the
+// first report reaching the host. Each mark is recorded only the first time it is reached.
+//
+// Every later mount (bus reset, re-enumeration) is timed as well: the gap between tud_mount_cb()
+// and the first report queued after it is kept as last and worst case over all mounts.
+typedef enum
+{
+  BOOT_MARK_MAIN = 0,      // Entered main()
+  BOOT_MARK_USB_INIT,      // tusb_init() returned, enumeration can start
+  BOOT_MARK_INPUT_READY,   // First complete input snapshot
+  BOOT_MARK_MOUNT,         // tud_mount_cb()
+  BOOT_MARK_FIRST_REPORT,  // First gamepad report queued after mount
+  BOOT_MARK_COUNT
+} boot_mark;
+
+void boot_profile_mark(boot_mark mark);
+void boot_profile_mounted(void);
+void boot_profile_first_report(void);
+uint16_t boot_profile_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* BOOT_PROFILE_H_ */
@@ -0,0 +1,104 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+/* Bootloader
+ * Small first-stage image that lives at the start of flash (after boot2) and starts one of the two
+ * firmware slots described in flash_layout.h. It owns the trial/rollback policy:
+ *
+ * - no valid boot control record: start slot A (factory state)
+ * - active slot confirmed: start it
+ * - active slot on trial: on the first attempt verify the image CRC recorded by the updater, then
+ *   count the attempt; after BOOT_TRIAL_ATTEMPTS unconfirmed boots, or if the image is bad, roll
+ *   back to the other slot
+ *
+ * A slot whose vector table does not look sane is never started; the other slot is tried instead.
+ * If neither slot is bootable the chip drops into the USB mass storage bootloader (BOOTSEL mode).
+ */
+
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "hardware/irq.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/scb.h"
+#include "flash_layout.h"
+#include "boot_control.h"
+
+static void __attribute__((noreturn)) start_slot(uint8_t slot)
+{
+  uint32_t const *vectors = (uint32_t const *) (XIP_BASE + boot_slot_offset(slot) + FLASH_SLOT_VECTOR_OFFSET);
+
+  // Hand over a quiet core: nothing of ours may fire once the application owns the vector table
+  irq_set_mask_enabled(0xFFFFFFFFu, false);
+
+  scb_hw->vtor = (uint32_t) vectors;
+  __asm volatile (
+    "msr msp, %0\n"
+    "bx %1\n"
+    : : "r" (vectors[0]), "r" (vectors[1]) : "memory");
+  __builtin_unreachable();
+}
+
+int main(void)
+{
+  // A watchdog reboot from the application may leave the watchdog running; the trial bookkeeping
+  // below erases flash and would not make the application's deadline. The application re-arms it.
+  hw_clear_bits(&watchdog_hw->ctrl, WATCHDOG_CTRL_ENABLE_BITS);
+
+  boot_control_t bc;
+  bool const have_record = boot_control_read(&bc);
+  uint8_t slot = bc.active_slot;
+  uint8_t const other = slot ^ 1;
+
+  if (have_record && bc.trial)
+  {
+    bool image_ok = boot_slot_vectors_valid(slot);
+
+    // Verify the whole image once, before its first start
+    if (image_ok && bc.attempts == 0 && bc.image_size[slot])
+    {
+      image_ok = boot_slot_crc(slot, bc.image_size[slot]) == bc.image_crc[slot];
+    }
+
+    if (!image_ok || bc.attempts >= BOOT_TRIAL_ATTEMPTS)
+    {
+      // Roll back: the previous slot was confirmed before the update started
+      bc.active_slot = other;
+      bc.trial = 0;
+      bc.attempts = 0;
+      slot = other;
+    }
+    else
+    {
+      bc.attempts++;
+    }
+    boot_control_write(&bc);
+  }
+
+  if (boot_slot_vectors_valid(slot)) start_slot(slot);
+  if (boot_slot_vectors_valid(slot ^ 1)) start_slot(slot ^ 1);
+
+  reset_usb_boot(0, 0);  // Nothing bootable: fall back to BOOTSEL mode so the unit can be reflashed
+  return 0;
+}
@@ -0,0 +1,137 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "flash_layout.h"
+#include "record_log.h"
+#include "button_stats.h"
+
+#define BUTTON_STATS_RECORD_SIZE 256
+
+// Persisted record
+typedef struct
+{
+  uint32_t presses[BUTTON_STATS_COUNT];
+  uint32_t histogram[BUTTON_STATS_COUNT][BUTTON_STATS_BUCKETS];
+} button_stats_record;
+
+_Static_assert(sizeof(button_stats_record) + RECORD_LOG_OVERHEAD <= BUTTON_STATS_RECORD_SIZE,
+               "button statistics record too small for BUTTON_STATS_COUNT buttons");
+
+static button_stats_record stats;
+static uint32_t press_start_us[BUTTON_STATS_COUNT];
+static uint8_t count;
+static uint8_t selected;
+
+static record_log stats_log;
+static bool dirty;
+static uint32_t last_save_us;
+
+void button_stats_init(uint8_t button_count)
+{
+  count = button_count < BUTTON_STATS_COUNT ? button_count : BUTTON_STATS_COUNT;
+  if (!record_log_open(&stats_log, FLASH_BUTTON_STATS_OFFSET, BUTTON_STATS_RECORD_SIZE, &stats, sizeof(stats)))
+  {
+    memset(&stats, 0, sizeof(stats));
+  }
+  last_save_us = time_us_32();
+}
+
+// 16, 64, 256, 1024, 4096 ms bounds
+static uint8_t duration_bucket(uint32_t ms)
+{
+  uint8_t bucket = 0;
+  for (ms >>= 4; ms && bucket < BUTTON_STATS_BUCKETS - 1; ms >>= 2) bucket++;
+  return bucket;
+}
+
+// Debounced state change: `pressed` has bit i set for each pressed physical button i
+void button_stats_edges(uint32_t pressed, uint32_t changed, uint32_t now_us)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    uint32_t const bit = 1u << i;
+    if (!(changed & bit)) continue;
+
+    if (pressed & bit)
+    {
+      press_start_us[i] = now_us;
+      stats.presses[i]++;
+    }
+    else
+    {
+      stats.histogram[i][duration_bucket((now_us - press_start_us[i]) / 1000)]++;
+    }
+  }
+  dirty = true;
+}
+
+// Batched save, checked from the sampling loop at a low rate
+void button_stats_poll(uint32_t now_us)
+{
+  if (!dirty || now_us - last_save_us < BUTTON_STATS_SAVE_MS * 1000u) return;
+
+  record_log_append(&stats_log, &stats, sizeof(stats));
+  last_save_us = now_us;
+  dirty = false;
+}
+
+//----------------------- Feature Report -----------------------//
+uint16_t button_stats_get_report(uint8_t *buffer, uint16_t reqlen)
+{
+  uint16_t const per_button = 4 + 4 * BUTTON_STATS_BUCKETS;
+  if (reqlen < 4 + BUTTON_STATS_PER_REPORT * per_button) return 0;
+
+  uint8_t n = 0;
+  uint8_t *p = &buffer[4];
+  for (uint8_t i = selected; i < count && n < BUTTON_STATS_PER_REPORT; i++, n++)
+  {
+    memcpy(p, &stats.presses[i], 4);
+    memcpy(p + 4, stats.histogram[i], 4 * BUTTON_STATS_BUCKETS);
+    p += per_button;
+  }
+
+  buffer[0] = selected;
+  buffer[1] = n;
+  buffer[2] = count;
+  buffer[3] = BUTTON_STATS_BUCKETS;
+  return (uint16_t) (p - buffer);
+}
+
+void button_stats_set_report(uint8_t const *buffer, uint16_t bufsize)
+{
+  if (bufsize < 1) return;
+  selected = buffer[0];
+
+  if (bufsize >= 2 && buffer[1] == BUTTON_STATS_CMD_RESET && selected < count)
+  {
+    // Edges are counted in the main loop too (input_convert), so there is nothing to race
+    stats.presses[selected] = 0;
+    memset(stats.histogram[selected], 0, sizeof(stats.histogram[selected]));
+    dirty = true;
+  }
+}
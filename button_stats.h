@@ -0,0 +1,67 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef BUTTON_STATS_H_
+#define BUTTON_STATS_H_
+
+#include <stdint.h>
+
+//----------------------- Button Actuation Statistics -----------------------//
+// Microswitches are rated for a number of actuations; counting them per physical button lets the
+// operator replace switches by use instead of by calendar. Counters and a press-duration histogram
+// are updated on debounced edges only, so the per-sample cost is nothing.
+//
+// Press durations are binned in BUTTON_STATS_BUCKETS buckets with bounds 16, 64, 256, 1024 and 4096 ms
+// (taps to long holds).
+//
+// The statistics are saved as one flash record every BUTTON_STATS_SAVE_MS if anything changed; the
+// record log (record_log.h) takes 16 saves per sector erase, which keeps the wear on the settings
+// sectors far below their rating for decades of continuous play. Presses since the last save are lost
+// on power-off.
+//
+// Exported through the button stats feature report, BUTTON_STATS_PER_REPORT buttons per report:
+//   SET:  u8 first_button, u8 command (BUTTON_STATS_CMD_RESET clears first_button, after a switch swap)
+//   GET:  u8 first_button, u8 buttons_in_reply, u8 button_count, u8 bucket_count,
+//         then per button { u32 presses, u32 histogram[BUTTON_STATS_BUCKETS] }
+#define BUTTON_STATS_COUNT        8   // At least the _button_config entries (pico_hid.c); more needs a bigger record
+#define BUTTON_STATS_BUCKETS      6
+#define BUTTON_STATS_SAVE_MS      (5 * 60 * 1000)
+#define BUTTON_STATS_REPORT_SIZE  63
+#define BUTTON_STATS_PER_REPORT   2
+
+typedef enum
+{
+  BUTTON_STATS_CMD_NONE = 0,
+  BUTTON_STATS_CMD_RESET,
+} button_stats_command;
+
+void button_stats_init(uint8_t button_count);
+void button_stats_edges(uint32_t pressed, uint32_t changed, uint32_t now_us);
+void button_stats_poll(uint32_t now_us);
+
+uint16_t button_stats_get_report(uint8_t *buffer, uint16_t reqlen);
+void button_stats_set_report(uint8_t const *buffer, uint16_t bufsize);
+
+#endif /* BUTTON_STATS_H_ */
@@ -0,0 +1,135 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "adc_correction.h"
+#include "calibration.h"
+#include "pico_hid.h"
+#include "tempco.h"
+#include "wheel.h"
+
+static uint8_t last_op = 0;
+static uint8_t last_error = CAL_ERR_NONE;
+
+static calibration_error handle_lut_data(uint8_t const *buf, uint16_t len)
+{
+  if (len < 4) return CAL_ERR_LENGTH;
+
+  uint16_t offset;
+  memcpy(&offset, &buf[1], 2);
+  uint8_t const count = buf[3];
+  if (count > CAL_LUT_BLOCK_MAX || len < 4 + count) return CAL_ERR_LENGTH;
+
+  return adc_correction_write(offset, (const int8_t *) &buf[4], count) ? CAL_ERR_NONE : CAL_ERR_SEQUENCE;
+}
+
+static calibration_error handle_predictor(uint8_t const *buf, uint16_t len)
+{
+  if (len < 8) return CAL_ERR_LENGTH;
+  if (buf[1] >= INPUT_AXIS_COUNT) return CAL_ERR_RANGE;
+
+  predictor_config config = { .alpha_q8 = buf[2], .beta_q8 = buf[3] };
+  memcpy(&config.horizon_us, &buf[4], 2);
+  memcpy(&config.overshoot, &buf[6], 2);
+  input_set_predictor(buf[1], &config);
+  return CAL_ERR_NONE;
+}
+
+static calibration_error handle_wheel(uint8_t const *buf, uint16_t len)
+{
+  if (len < 4) return CAL_ERR_LENGTH;
+
+  uint16_t lock;
+  memcpy(&lock, &buf[1], 2);
+  wheel_set_lock(lock);
+  if (buf[3]) wheel_recenter();
+  return CAL_ERR_NONE;
+}
+
+static calibration_error handle_pedal(uint8_t const *buf, uint16_t len)
+{
+  if (len < 7) return CAL_ERR_LENGTH;
+
+  uint16_t rest, full;
+  memcpy(&rest, &buf[2], 2);
+  memcpy(&full, &buf[4], 2);
+  return wheel_set_pedal(buf[1], rest, full, buf[6]) ? CAL_ERR_NONE : CAL_ERR_RANGE;
+}
+
+static calibration_error handle_lut_commit(uint8_t const *buf, uint16_t len)
+{
+  if (len < 5) return CAL_ERR_LENGTH;
+
+  uint32_t crc;
+  memcpy(&crc, &buf[1], 4);
+  if (adc_correction_next_offset() != ADC_CODES) return CAL_ERR_SEQUENCE;
+  return adc_correction_commit(crc) ? CAL_ERR_NONE : CAL_ERR_CRC;
+}
+
+// Handle SET_FEATURE for the calibration report: one command per report
+void calibration_set_report(uint8_t const *buffer, uint16_t bufsize)
+{
+  if (bufsize < 1) return;
+
+  calibration_error error = CAL_ERR_NONE;
+  switch (buffer[0])
+  {
+    case CAL_OP_LUT_BEGIN:  adc_correction_begin(); break;
+    case CAL_OP_LUT_DATA:   error = handle_lut_data(buffer, bufsize); break;
+    case CAL_OP_LUT_COMMIT: error = handle_lut_commit(buffer, bufsize); break;
+    case CAL_OP_LUT_CLEAR:  adc_correction_clear(); break;
+    case CAL_OP_HYSTERESIS:
+      if (bufsize < 3) { error = CAL_ERR_LENGTH; break; }
+      if (buffer[1] >= REPORT_AXIS_COUNT) { error = CAL_ERR_RANGE; break; }
+      input_set_hysteresis(buffer[1], buffer[2]);
+      break;
+    case CAL_OP_TEMPCO_POINT:  tempco_capture(); break;
+    case CAL_OP_TEMPCO_COMMIT: error = tempco_commit() ? CAL_ERR_NONE : CAL_ERR_FIT; break;
+    case CAL_OP_TEMPCO_CLEAR:  tempco_clear(); break;
+    case CAL_OP_PREDICTOR:     error = handle_predictor(buffer, bufsize); break;
+    case CAL_OP_WHEEL:         error = handle_wheel(buffer, bufsize); break;
+    case CAL_OP_PEDAL:         error = handle_pedal(buffer, bufsize); break;
+    case CAL_OP_LUT_RAW:
+      if (bufsize < 2) { error = CAL_ERR_LENGTH; break; }
+      adc_correction_raw(buffer[1] != 0);
+      break;
+    default:                error = CAL_ERR_UNKNOWN_OP; break;
+  }
+  last_op = buffer[0];
+  last_error = error;
+}
+
+// Handle GET_FEATURE for the calibration report: status of the last command
+uint16_t calibration_get_report(uint8_t *buffer, uint16_t reqlen)
+{
+  if (reqlen < 5) return 0;
+
+  uint16_t const next = adc_correction_next_offset();
+  buffer[0] = last_op;
+  buffer[1] = last_error;
+  memcpy(&buffer[2], &next, 2);
+  buffer[4] = adc_correction_source();
+  return 5;
+}
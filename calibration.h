@@ -0,0 +1,86 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef CALIBRATION_H_
+#define CALIBRATION_H_
+
+#include <stdint.h>
+
+//----------------------- Calibration Feature Report -----------------------//
+// Factory-station access to the per-unit calibration data kept in the settings flash area. Every
+// SET_FEATURE carries one command; GET_FEATURE returns the status of the last one.
+//
+//   LUT_BEGIN   u8 op                                  erase the stored ADC correction table
+//   LUT_DATA    u8 op, u16 offset, u8 len, i8 delta[len]   (len <= CAL_LUT_BLOCK_MAX, in order)
+//   LUT_COMMIT  u8 op, u32 crc32                       check the stored deltas and switch to them
+//   LUT_CLEAR   u8 op                                  drop the table, back to the errata model
+//   HYSTERESIS  u8 op, u8 axis, u8 band                output quantizer band of a report axis (mixer.h), in ADC codes (not stored)
+//   PREDICTOR   u8 op, u8 axis, u8 alpha, u8 beta, u16 horizon_us, u16 overshoot
+//                                                      latency predictor (predictor.h), horizon 0 = off (not stored)
+//   TEMPCO_POINT   u8 op                               capture the resting sticks and the temperature
+//   TEMPCO_COMMIT  u8 op                               fit and store the model from the last two captures
+//   TEMPCO_CLEAR   u8 op                               drop the temperature model
+//   WHEEL       u8 op, u16 lock_deg, u8 recenter       wheel lock-to-lock rotation, recenter at the current
+//                                                      position if recenter != 0 (wheel.h, not stored)
+//   PEDAL       u8 op, u8 pedal, u16 rest, u16 full, u8 curve
+//                                                      pedal range and response curve (wheel.h, not stored)
+//   LUT_RAW     u8 op, u8 raw                          raw != 0: no ADC correction, so the telemetry MUX page
+//                                                      carries uncorrected codes for a sweep (not stored)
+//
+//   status:     u8 last_op, u8 error, u16 lut_next_offset, u8 lut_source (adc_lut_source)
+#define CAL_REPORT_SIZE    63
+#define CAL_LUT_BLOCK_MAX  56
+
+typedef enum
+{
+  CAL_OP_LUT_BEGIN = 1,
+  CAL_OP_LUT_DATA,
+  CAL_OP_LUT_COMMIT,
+  CAL_OP_LUT_CLEAR,
+  CAL_OP_HYSTERESIS,
+  CAL_OP_TEMPCO_POINT,
+  CAL_OP_TEMPCO_COMMIT,
+  CAL_OP_TEMPCO_CLEAR,
+  CAL_OP_PREDICTOR,
+  CAL_OP_WHEEL,
+  CAL_OP_PEDAL,
+  CAL_OP_LUT_RAW,
+} calibration_op;
+
+typedef enum
+{
+  CAL_ERR_NONE = 0,
+  CAL_ERR_UNKNOWN_OP,
+  CAL_ERR_LENGTH,
+  CAL_ERR_SEQUENCE,
+  CAL_ERR_CRC,
+  CAL_ERR_FIT,        // Temperature captures missing, too close together, or implausible
+  CAL_ERR_RANGE,      // Argument out of range, e.g. an axis index past the last axis
+} calibration_error;
+
+uint16_t calibration_get_report(uint8_t *buffer, uint16_t reqlen);
+void calibration_set_report(uint8_t const *buffer, uint16_t bufsize);
+
+#endif /* CALIBRATION_H_ */
@@ -0,0 +1,80 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "cpu_load.h"
+
+static uint8_t depth;          // Open brackets
+static uint32_t busy_start;    // time_us_32() when the outermost bracket opened
+static uint32_t busy_us;       // Busy time in the current window
+static uint32_t window_start;
+
+static uint16_t load;          // Last complete window, 0.01 %
+static uint16_t peak;          // Highest window since boot, 0.01 %
+static uint32_t windows;
+
+void cpu_load_enter(void)
+{
+  uint32_t const irq = save_and_disable_interrupts();
+  if (depth++ == 0) busy_start = time_us_32();
+  restore_interrupts(irq);
+}
+
+void cpu_load_exit(void)
+{
+  uint32_t const irq = save_and_disable_interrupts();
+  if (--depth == 0)
+  {
+    uint32_t const now = time_us_32();
+    busy_us += now - busy_start;
+
+    uint32_t const elapsed = now - window_start;
+    if (elapsed >= CPU_LOAD_WINDOW_US)
+    {
+      load = (uint16_t) ((uint64_t) busy_us * 10000 / elapsed);
+      if (load > peak) peak = load;
+      windows++;
+      busy_us = 0;
+      window_start = now;
+    }
+  }
+  restore_interrupts(irq);
+}
+
+// Telemetry page: u16 load of the last window (0.01 %), u16 peak load (0.01 %), u32 windows,
+// u32 window length (us)
+uint16_t cpu_load_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 12) return 0;
+
+  uint32_t const window = CPU_LOAD_WINDOW_US;
+  memcpy(&buf[0], &load, 2);
+  memcpy(&buf[2], &peak, 2);
+  memcpy(&buf[4], &windows, 4);
+  memcpy(&buf[8], &window, 4);
+  return 12;
+}
@@ -0,0 +1,44 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef CPU_LOAD_H_
+#define CPU_LOAD_H_
+
+#include <stdint.h>
+
+//----------------------- CPU Load -----------------------//
+// Measures the share of CPU time spent in bracketed work. Brackets may nest, including an interrupt
+// handler bracket inside a main-loop bracket; only the outermost one is timed, so nothing is counted
+// twice. The load is computed over windows of CPU_LOAD_WINDOW_US and reported in 0.01 % units.
+//
+// Timing uses the 1 us system timer. Each bracket is off by less than 1 us either way, which
+// averages out over a window.
+#define CPU_LOAD_WINDOW_US 1000000
+
+void cpu_load_enter(void);
+void cpu_load_exit(void);
+uint16_t cpu_load_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* CPU_LOAD_H_ */
@@ -0,0 +1,253 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "flash_layout.h"
+#include "record_log.h"
+#include "tempco.h"
+#include "drift.h"
+
+typedef struct
+{
+  int32_t center_q16;   // Center estimate at the tempco reference temperature, 16.16 ADC codes
+  int32_t offset_q16;   // Temperature shift of the center at the current temperature (tempco.c)
+  int32_t mean_q16;     // Fast average of the input (~8 ticks)
+  int32_t dev_q16;      // Average absolute deviation from mean_q16 (~16 ticks)
+  uint16_t home;        // Center measured on the first boot; the estimate is clamped around it
+
+  // Derived from center_q16 + offset_q16 on every change, used per sample
+  uint16_t center;
+  uint32_t gain_pos_q16;  // Output codes per input code above / below the deadzone
+  uint32_t gain_neg_q16;
+} axis_drift;
+
+// Persisted record
+typedef struct
+{
+  int32_t center_q16[DRIFT_AXIS_COUNT];
+  uint16_t home[DRIFT_AXIS_COUNT];
+} drift_record;
+
+static axis_drift drift[DRIFT_AXIS_COUNT];
+static uint32_t rest_ticks;
+static uint32_t tick_count;
+
+static record_log drift_log;
+static drift_record saved;
+static uint32_t save_count;
+
+static void update_center(axis_drift *a)
+{
+  // The temperature offset comes on top of the drift clamp; keep at least one code of travel past the
+  // deadzone on both sides so the spans below stay positive
+  int32_t center = (a->center_q16 + a->offset_q16 + 0x8000) >> 16;
+  if (center < DRIFT_DEADZONE + 1) center = DRIFT_DEADZONE + 1;
+  if (center > 4094 - DRIFT_DEADZONE) center = 4094 - DRIFT_DEADZONE;
+  if (center == a->center && a->gain_pos_q16) return;
+
+  // Stretch each side so the full stick travel still reaches the ends of the output range
+  // (rounded up so the ends are reached; the result is clamped)
+  uint32_t const span_pos = 4095 - center - DRIFT_DEADZONE;
+  uint32_t const span_neg = center - DRIFT_DEADZONE;
+  uint32_t const gain_pos = (((uint32_t) (4095 - DRIFT_OUTPUT_CENTER) << 16) + span_pos - 1) / span_pos;
+  uint32_t const gain_neg = (((uint32_t) DRIFT_OUTPUT_CENTER << 16) + span_neg - 1) / span_neg;
+
+  a->center = (uint16_t) center;
+  a->gain_pos_q16 = gain_pos;
+  a->gain_neg_q16 = gain_neg;
+}
+
+static void set_center(axis_drift *a, int32_t center_q16)
+{
+  int32_t const lo = (int32_t) (a->home - DRIFT_CLAMP) << 16;
+  int32_t const hi = (int32_t) (a->home + DRIFT_CLAMP) << 16;
+  if (center_q16 < lo) center_q16 = lo;
+  if (center_q16 > hi) center_q16 = hi;
+  a->center_q16 = center_q16;
+  update_center(a);
+}
+
+static uint16_t clamp_home(int32_t home)
+{
+  if (home < DRIFT_CLAMP + DRIFT_DEADZONE + 1 || home > 4095 - DRIFT_CLAMP - DRIFT_DEADZONE - 1)
+  {
+    return DRIFT_OUTPUT_CENTER;  // Stick held to one side at first boot, fall back to mid-scale
+  }
+  return (uint16_t) home;
+}
+
+// Start from the saved estimate, or take the first sample as the home center. The temperature
+// model must be loaded first: centers are kept at the reference temperature.
+void drift_init(const uint16_t *raw)
+{
+  bool const restored = record_log_open(&drift_log, FLASH_DRIFT_LOG_OFFSET, RECORD_LOG_RECORD_SIZE, &saved, sizeof(saved));
+
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    axis_drift *a = &drift[i];
+    a->offset_q16 = tempco_offset_q16(i);
+    a->home = restored ? saved.home[i] : clamp_home(raw[i] - ((a->offset_q16 + 0x8000) >> 16));
+    a->mean_q16 = (int32_t) raw[i] << 16;
+    a->dev_q16 = 0;
+    set_center(a, restored ? saved.center_q16[i] : (int32_t) a->home << 16);
+    saved.center_q16[i] = a->center_q16;
+    saved.home[i] = a->home;
+  }
+}
+
+static void save(void)
+{
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    saved.center_q16[i] = drift[i].center_q16;
+    saved.home[i] = drift[i].home;
+  }
+  record_log_append(&drift_log, &saved, sizeof(saved));
+  save_count++;
+}
+
+static void save_if_moved(void)
+{
+  bool moved = false;
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    int32_t const d = drift[i].center_q16 - saved.center_q16[i];
+    moved |= d >= (1 << 16) || d <= -(1 << 16);
+  }
+  if (moved) save();
+}
+
+// Estimator step, every DRIFT_TICK_US
+void drift_tick(const uint16_t *raw)
+{
+  bool rest = true;
+
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    axis_drift *a = &drift[i];
+    int32_t const x = (int32_t) raw[i] << 16;
+    int32_t const e = x - a->mean_q16;
+
+    a->mean_q16 += e >> 3;
+    a->dev_q16 += ((e < 0 ? -e : e) - a->dev_q16) >> 4;
+
+    // Follow the temperature model (changes at the temperature sample rate at most)
+    a->offset_q16 = tempco_offset_q16(i);
+    update_center(a);
+
+    int32_t const off = a->mean_q16 - (a->center_q16 + a->offset_q16);
+    rest &= off < (DRIFT_DEADZONE << 16) && off > -(DRIFT_DEADZONE << 16);
+    rest &= a->dev_q16 < (DRIFT_REST_NOISE << 16);
+  }
+
+  rest_ticks = rest ? rest_ticks + (rest_ticks < UINT32_MAX) : 0;
+
+  if (drift_at_rest())
+  {
+    for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+    {
+      axis_drift *a = &drift[i];
+      int32_t step = (a->mean_q16 - (a->center_q16 + a->offset_q16)) >> DRIFT_GAIN_SHIFT;
+      if (step > DRIFT_STEP_MAX_Q16) step = DRIFT_STEP_MAX_Q16;
+      if (step < -DRIFT_STEP_MAX_Q16) step = -DRIFT_STEP_MAX_Q16;
+      set_center(a, a->center_q16 + step);
+    }
+  }
+
+  if (++tick_count * (DRIFT_TICK_US / 1000) >= DRIFT_SAVE_INTERVAL_MS)
+  {
+    tick_count = 0;
+    save_if_moved();
+  }
+}
+
+// True while the sticks are confidently at rest (the same condition that lets the centers move)
+bool drift_at_rest(void)
+{
+  return rest_ticks * (DRIFT_TICK_US / 1000) >= DRIFT_SETTLE_MS;
+}
+
+// Fast average of the input, for calibration captures
+int32_t drift_mean_q16(uint8_t axis)
+{
+  return drift[axis].mean_q16;
+}
+
+// The temperature model changed: move the reference-temperature centers by `delta_q16` so the
+// effective centers stay where they are, and save right away so both records agree after a reset
+void drift_rebase(const int32_t *delta_q16)
+{
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    axis_drift *a = &drift[i];
+    a->home = clamp_home(a->home + ((delta_q16[i] + 0x8000) >> 16));
+    a->offset_q16 = tempco_offset_q16(i);
+    set_center(a, a->center_q16 + delta_q16[i]);
+  }
+  save();
+}
+
+// Recenter one sample: DRIFT_OUTPUT_CENTER inside the deadzone, scaled to the full range outside it
+uint16_t drift_condition(uint8_t axis, uint16_t raw)
+{
+  axis_drift const *a = &drift[axis];
+  int32_t const d = (int32_t) raw - a->center;
+  int32_t out = DRIFT_OUTPUT_CENTER;
+
+  if (d > DRIFT_DEADZONE)
+  {
+    out += (int32_t) (((uint32_t) (d - DRIFT_DEADZONE) * a->gain_pos_q16) >> 16);
+  }
+  else if (d < -DRIFT_DEADZONE)
+  {
+    out -= (int32_t) (((uint32_t) (-d - DRIFT_DEADZONE) * a->gain_neg_q16) >> 16);
+  }
+
+  if (out < 0) out = 0;
+  if (out > 4095) out = 4095;
+  return (uint16_t) out;
+}
+
+// Telemetry page: per axis { i32 center_q16, u16 home, u16 deviation (1/256 codes) },
+// then u32 rest_ticks, u32 save_count
+uint16_t drift_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < DRIFT_AXIS_COUNT * 8 + 8) return 0;
+
+  uint8_t *p = buf;
+  for (int i = 0; i < DRIFT_AXIS_COUNT; i++)
+  {
+    uint16_t const dev = (uint16_t) (drift[i].dev_q16 >> 8);
+    memcpy(p, &drift[i].center_q16, 4);
+    memcpy(p + 4, &drift[i].home, 2);
+    memcpy(p + 6, &dev, 2);
+    p += 8;
+  }
+  memcpy(p, &rest_ticks, 4);
+  memcpy(p + 4, &save_count, 4);
+  return (uint16_t) (p + 8 - buf);
+}
@@ -0,0 +1,69 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef DRIFT_H_
+#define DRIFT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Stick Drift Tracking -----------------------//
+// Potentiometer sticks drift with wear and temperature, so the center measured at boot goes stale
+// over a long session. Each axis keeps a center estimate that follows the stick slowly, but only
+// while the stick is confidently at rest:
+//   - both axes inside the deadzone around their current center,
+//   - both axes quiet (mean absolute deviation below DRIFT_REST_NOISE),
+//   - and for at least DRIFT_SETTLE_MS in a row.
+// Even then the center moves at most DRIFT_STEP_MAX_Q16 per tick (about 15 codes per minute) and
+// never further than DRIFT_CLAMP from the home center. A deliberate small hold either leaves the
+// deadzone, shows the hand's tremor, or is too short for the rate limit to move the center by more
+// than a code or two.
+//
+// Centers are kept at the reference temperature of the stick temperature model (tempco.h), whose
+// shift is added on top; the estimator only has to follow what the model does not explain.
+//
+// The per-sample work is a subtract, a compare and a multiply; the estimator itself runs every
+// DRIFT_TICK_US. The estimate is saved to flash every DRIFT_SAVE_INTERVAL_MS if it has moved.
+#define DRIFT_AXIS_COUNT         2
+#define DRIFT_TICK_US            1000
+#define DRIFT_DEADZONE           48      // ADC codes either side of the center reported as centered
+#define DRIFT_REST_NOISE         6       // ADC codes, mean absolute deviation of a resting stick
+#define DRIFT_SETTLE_MS          1000
+#define DRIFT_GAIN_SHIFT         10      // Estimator time constant of 2^10 ticks (~1 s)
+#define DRIFT_STEP_MAX_Q16       16      // 1/4096 code per tick
+#define DRIFT_CLAMP              160     // ADC codes from the home center
+#define DRIFT_SAVE_INTERVAL_MS   (10 * 60 * 1000)
+
+#define DRIFT_OUTPUT_CENTER      2048
+
+void drift_init(const uint16_t *raw);
+void drift_tick(const uint16_t *raw);
+uint16_t drift_condition(uint8_t axis, uint16_t raw);
+bool drift_at_rest(void);
+int32_t drift_mean_q16(uint8_t axis);
+void drift_rebase(const int32_t *delta_q16);
+uint16_t drift_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* DRIFT_H_ */
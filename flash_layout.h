@@ -0,0 +1,59 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef FLASH_LAYOUT_H_
+#define FLASH_LAYOUT_H_
+
+//----------------------- Flash Layout -----------------------//
+// Offsets from the start of the 2 MB flash (XIP_BASE). The slot origins are repeated in
+// CMakeLists.txt for the slot linker scripts; keep both in sync.
+//
+//   0x000000  bootloader (boot2 + slot selection)              56 KB
+//   0x00E000  boot control, two ping-pong sectors                8 KB
+//   0x010000  firmware slot A                                  960 KB
+//   0x100000  firmware slot B                                  960 KB
+//   0x1F0000  settings (calibration, persisted counters)        64 KB
+//
+// A slot holds a complete image linked for that address, including its own (unused) boot2 in the
+// first 256 bytes; the vector table follows at FLASH_SLOT_VECTOR_OFFSET.
+#define FLASH_BOOTLOADER_OFFSET      0x000000u
+#define FLASH_BOOTLOADER_SIZE        0x00E000u
+#define FLASH_BOOT_CONTROL_OFFSET    0x00E000u
+#define FLASH_BOOT_CONTROL_COPIES    2
+#define FLASH_SLOT_A_OFFSET          0x010000u
+#define FLASH_SLOT_SIZE              0x0F0000u
+#define FLASH_SLOT_B_OFFSET          (FLASH_SLOT_A_OFFSET + FLASH_SLOT_SIZE)
+#define FLASH_SETTINGS_OFFSET        (FLASH_SLOT_B_OFFSET + FLASH_SLOT_SIZE)
+#define FLASH_SETTINGS_SIZE          0x010000u
+#define FLASH_SLOT_VECTOR_OFFSET     0x100u
+
+// Settings area, one region per user (offsets and sizes are whole sectors)
+#define FLASH_ADC_LUT_OFFSET         (FLASH_SETTINGS_OFFSET + 0x0000u)  // ADC correction table, 8 KB
+#define FLASH_ADC_LUT_SIZE           0x2000u
+#define FLASH_DRIFT_LOG_OFFSET       (FLASH_SETTINGS_OFFSET + 0x2000u)  // Stick center estimates, record log (8 KB)
+#define FLASH_TEMPCO_LOG_OFFSET      (FLASH_SETTINGS_OFFSET + 0x4000u)  // Stick temperature model, record log (8 KB)
+#define FLASH_BUTTON_STATS_OFFSET    (FLASH_SETTINGS_OFFSET + 0x6000u)  // Button actuation counters, record log (8 KB)
+
+#endif /* FLASH_LAYOUT_H_ */
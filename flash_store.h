@@ -0,0 +1,46 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef FLASH_STORE_H_
+#define FLASH_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+//----------------------- Settings Flash Access -----------------------//
+// Erase/program helpers for the settings area (flash_layout.h). Both stall the whole chip, so they
+// run with interrupts disabled and widen the watchdog deadline for the duration. Offsets are from
+// the start of flash and must be sector (erase) or page (program) aligned.
+void flash_store_erase(uint32_t offset, size_t len);
+void flash_store_program(uint32_t offset, const uint8_t *data, size_t len);
+
+// Read-only view of flash contents through XIP
+static inline const void *flash_store_ptr(uint32_t offset)
+{
+  return (const void *) (XIP_BASE + offset);
+}
+
+#endif /* FLASH_STORE_H_ */
@@ -0,0 +1,272 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/scb.h"
+#include "tusb.h"
+#include "flash_layout.h"
+#include "boot_control.h"
+#include "crc32.h"
+#include "supervisor.h"
+#include "fw_update.h"
+
+#define NO_SLOT          0xFF
+#define VERIFY_CHUNK     4096  // Bytes checksummed per fw_update_task() call
+#define ACTIVATE_DELAY_MS 20   // Lets the ACTIVATE control transfer finish before rebooting
+
+static struct
+{
+  uint8_t state;          // fw_update_state
+  uint8_t error;          // fw_update_error of the last rejected command
+  uint8_t running_slot;   // Slot we execute from, NO_SLOT without the bootloader
+  uint8_t target_slot;    // Slot being written
+  uint32_t image_size;
+  uint32_t image_crc;
+  uint32_t next_offset;   // Next image byte expected from the host
+  uint32_t work_offset;   // Erase / verify progress
+  uint32_t verify_crc;
+  uint32_t activate_at_ms;
+  bool confirmed;         // Trial boot of this image already confirmed
+  uint8_t page[FLASH_PAGE_SIZE];  // Collects DATA blocks into whole flash pages
+} fw;
+
+static boot_control_t boot;
+
+void fw_update_init(void)
+{
+  uint32_t const vtor = scb_hw->vtor;
+
+  boot_control_read(&boot);
+
+  fw.running_slot = NO_SLOT;
+  for (uint8_t slot = 0; slot < BOOT_SLOT_COUNT; slot++)
+  {
+    if (vtor == XIP_BASE + boot_slot_offset(slot) + FLASH_SLOT_VECTOR_OFFSET) fw.running_slot = slot;
+  }
+  fw.target_slot = fw.running_slot == NO_SLOT ? NO_SLOT : fw.running_slot ^ 1;
+  fw.confirmed = !boot.trial;
+}
+
+static uint32_t target_offset(void)
+{
+  return boot_slot_offset(fw.target_slot);
+}
+
+static void program_page(uint32_t image_offset)
+{
+  uint32_t const irq = save_and_disable_interrupts();
+  flash_range_program(target_offset() + image_offset, fw.page, FLASH_PAGE_SIZE);
+  restore_interrupts(irq);
+}
+
+static void reject(fw_update_error error)
+{
+  fw.error = error;
+}
+
+static void handle_begin(uint8_t const *buf, uint16_t len)
+{
+  if (len < 9) { reject(FW_ERR_BAD_STATE); return; }
+  if (fw.running_slot == NO_SLOT) { reject(FW_ERR_NOT_SLOTTED); return; }
+
+  uint32_t size, crc;
+  memcpy(&size, &buf[1], 4);
+  memcpy(&crc, &buf[5], 4);
+  if (size == 0 || size > FLASH_SLOT_SIZE) { reject(FW_ERR_TOO_LARGE); return; }
+
+  fw.image_size = size;
+  fw.image_crc = crc;
+  fw.next_offset = 0;
+  fw.work_offset = 0;
+  fw.error = FW_ERR_NONE;
+  fw.state = FW_STATE_ERASING;
+}
+
+static void handle_data(uint8_t const *buf, uint16_t len)
+{
+  if (fw.state != FW_STATE_RECEIVING) { reject(FW_ERR_BAD_STATE); return; }
+  if (len < 10) { reject(FW_ERR_SEQUENCE); return; }
+
+  uint32_t offset, crc;
+  memcpy(&offset, &buf[1], 4);
+  uint8_t const n = buf[5];
+  memcpy(&crc, &buf[6], 4);
+  uint8_t const *data = &buf[10];
+
+  if (offset != fw.next_offset || n > FW_UPDATE_BLOCK_MAX || 10u + n > len
+      || offset + n > fw.image_size)
+  {
+    reject(FW_ERR_SEQUENCE);
+    return;
+  }
+  if (crc32_update(0, data, n) != crc) { reject(FW_ERR_BLOCK_CRC); return; }
+
+  // Blocks do not line up with flash pages; program each page as soon as it is complete
+  while (n && fw.next_offset < offset + n)
+  {
+    uint32_t const in_page = fw.next_offset % FLASH_PAGE_SIZE;
+    uint32_t chunk = FLASH_PAGE_SIZE - in_page;
+    uint32_t const left = offset + n - fw.next_offset;
+    if (chunk > left) chunk = left;
+
+    memcpy(&fw.page[in_page], &data[fw.next_offset - offset], chunk);
+    fw.next_offset += chunk;
+
+    if (fw.next_offset % FLASH_PAGE_SIZE == 0) program_page(fw.next_offset - FLASH_PAGE_SIZE);
+  }
+  fw.error = FW_ERR_NONE;
+}
+
+static void handle_finish(void)
+{
+  if (fw.state != FW_STATE_RECEIVING || fw.next_offset != fw.image_size) { reject(FW_ERR_BAD_STATE); return; }
+
+  // Flush the last partial page, padded with erased bytes
+  uint32_t const in_page = fw.next_offset % FLASH_PAGE_SIZE;
+  if (in_page)
+  {
+    memset(&fw.page[in_page], 0xFF, FLASH_PAGE_SIZE - in_page);
+    program_page(fw.next_offset - in_page);
+  }
+
+  fw.work_offset = 0;
+  fw.verify_crc = 0;
+  fw.state = FW_STATE_VERIFYING;
+}
+
+static void handle_activate(void)
+{
+  if (fw.state != FW_STATE_VERIFIED) { reject(FW_ERR_BAD_STATE); return; }
+
+  fw.activate_at_ms = to_ms_since_boot(get_absolute_time()) + ACTIVATE_DELAY_MS;
+  fw.state = FW_STATE_ACTIVATING;
+}
+
+// Handle SET_FEATURE for the firmware update report (buffer excludes the report ID)
+void fw_update_set_report(uint8_t const *buffer, uint16_t bufsize)
+{
+  if (bufsize < 1) return;
+
+  switch (buffer[0])
+  {
+    case FW_OP_BEGIN:    handle_begin(buffer, bufsize); break;
+    case FW_OP_DATA:     handle_data(buffer, bufsize); break;
+    case FW_OP_FINISH:   handle_finish(); break;
+    case FW_OP_ACTIVATE: handle_activate(); break;
+    case FW_OP_ABORT:    fw.state = FW_STATE_IDLE; fw.error = FW_ERR_NONE; break;
+    default:             reject(FW_ERR_BAD_STATE); break;
+  }
+}
+
+// Handle GET_FEATURE for the firmware update report: current status
+uint16_t fw_update_get_report(uint8_t *buffer, uint16_t reqlen)
+{
+  if (reqlen < 11) return 0;
+
+  buffer[0] = fw.state;
+  buffer[1] = fw.error;
+  memcpy(&buffer[2], &fw.next_offset, 4);
+  buffer[6] = fw.running_slot;
+  buffer[7] = fw.target_slot;
+  buffer[8] = boot.trial;
+  buffer[9] = boot.attempts;
+  buffer[10] = FW_UPDATE_BLOCK_MAX;
+  return 11;
+}
+
+// Slow steps run here, one bounded piece per call, so the superloop keeps servicing USB
+void fw_update_task(void)
+{
+  switch (fw.state)
+  {
+    case FW_STATE_ERASING:
+    {
+      // One sector per call; an erase can take up to a few hundred milliseconds
+      supervisor_begin_long_operation();
+      uint32_t const irq = save_and_disable_interrupts();
+      flash_range_erase(target_offset() + fw.work_offset, FLASH_SECTOR_SIZE);
+      restore_interrupts(irq);
+      supervisor_end_long_operation();
+
+      fw.work_offset += FLASH_SECTOR_SIZE;
+      if (fw.work_offset >= fw.image_size) fw.state = FW_STATE_RECEIVING;
+    }
+    break;
+
+    case FW_STATE_VERIFYING:
+    {
+      uint32_t chunk = fw.image_size - fw.work_offset;
+      if (chunk > VERIFY_CHUNK) chunk = VERIFY_CHUNK;
+
+      fw.verify_crc = crc32_update(fw.verify_crc, (const void *) (XIP_BASE + target_offset() + fw.work_offset), chunk);
+      fw.work_offset += chunk;
+
+      if (fw.work_offset >= fw.image_size)
+      {
+        bool const ok = fw.verify_crc == fw.image_crc && boot_slot_vectors_valid(fw.target_slot);
+        fw.error = ok ? FW_ERR_NONE : FW_ERR_IMAGE_CRC;
+        fw.state = ok ? FW_STATE_VERIFIED : FW_STATE_FAILED;
+      }
+    }
+    break;
+
+    case FW_STATE_ACTIVATING:
+      if ((int32_t) (to_ms_since_boot(get_absolute_time()) - fw.activate_at_ms) < 0) break;
+
+      boot.active_slot = fw.target_slot;
+      boot.trial = 1;
+      boot.attempts = 0;
+      boot.image_size[fw.target_slot] = fw.image_size;
+      boot.image_crc[fw.target_slot] = fw.image_crc;
+
+      supervisor_begin_long_operation();
+      boot_control_write(&boot);
+      watchdog_reboot(0, 0, 1);  // Back through the bootloader into the new slot
+      while (1) tight_loop_contents();
+
+    default:
+      // Confirm a trial boot once the host has been talking to us for a while
+      if (!fw.confirmed && fw.running_slot == boot.active_slot && tud_mounted())
+      {
+        static uint32_t mounted_since_ms = 0;
+        uint32_t const now = to_ms_since_boot(get_absolute_time());
+
+        if (!mounted_since_ms) mounted_since_ms = now;
+        if (now - mounted_since_ms < FW_UPDATE_CONFIRM_MS) break;
+
+        boot.trial = 0;
+        boot.attempts = 0;
+        supervisor_begin_long_operation();
+        boot_control_write(&boot);
+        supervisor_end_long_operation();
+        fw.confirmed = true;
+      }
+      break;
+  }
+}
@@ -0,0 +1,89 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef FW_UPDATE_H_
+#define FW_UPDATE_H_
+
+#include <stdint.h>
+
+//----------------------- Firmware Update over HID -----------------------//
+// Writes a new image into the slot that is not running, using the firmware update feature report.
+// Every SET_FEATURE carries one command; GET_FEATURE returns the status below. The host streams DATA
+// blocks back to back (the control pipe only completes a transfer once the block is stored, which
+// gives flow control for free) and polls the status around the slow steps (erase, verify).
+//
+//   BEGIN    u8 op, u32 image_size, u32 image_crc32
+//   DATA     u8 op, u32 offset, u8 len, u32 block_crc32, u8 data[len]   (len <= FW_UPDATE_BLOCK_MAX)
+//   FINISH   u8 op                                     flush and verify the whole image
+//   ACTIVATE u8 op                                     mark the new slot for a trial boot and reboot
+//   ABORT    u8 op
+//
+//   status:  u8 state, u8 error, u32 next_offset, u8 running_slot, u8 target_slot, u8 trial,
+//            u8 attempts, u8 block_max
+//
+// Blocks must arrive in order; a block with the wrong offset or a bad CRC is dropped and reported in
+// `error`, and the host resumes from `next_offset`. The new image runs on trial until it has been
+// mounted for FW_UPDATE_CONFIRM_MS, otherwise the bootloader rolls back (see boot_control.h).
+#define FW_UPDATE_REPORT_SIZE  63
+#define FW_UPDATE_BLOCK_MAX    52
+#define FW_UPDATE_CONFIRM_MS   3000
+
+typedef enum
+{
+  FW_OP_BEGIN = 1,
+  FW_OP_DATA,
+  FW_OP_FINISH,
+  FW_OP_ACTIVATE,
+  FW_OP_ABORT,
+} fw_update_op;
+
+typedef enum
+{
+  FW_STATE_IDLE = 0,
+  FW_STATE_ERASING,
+  FW_STATE_RECEIVING,
+  FW_STATE_VERIFYING,
+  FW_STATE_VERIFIED,
+  FW_STATE_ACTIVATING,
+  FW_STATE_FAILED,
+} fw_update_state;
+
+typedef enum
+{
+  FW_ERR_NONE = 0,
+  FW_ERR_NOT_SLOTTED,  // Running without the bootloader (plain BOOTSEL image), updates unavailable
+  FW_ERR_TOO_LARGE,
+  FW_ERR_BAD_STATE,
+  FW_ERR_SEQUENCE,
+  FW_ERR_BLOCK_CRC,
+  FW_ERR_IMAGE_CRC,
+} fw_update_error;
+
+void fw_update_init(void);
+void fw_update_task(void);
+uint16_t fw_update_get_report(uint8_t *buffer, uint16_t reqlen);
+void fw_update_set_report(uint8_t const *buffer, uint16_t bufsize);
+
+#endif /* FW_UPDATE_H_ */
@@ -0,0 +1,269 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/timer.h"
+#include "hardware/uart.h"
+#if LIB_PICO_STDIO_UART
+#include "pico/stdio_uart.h"
+#endif
+#include "jvs.h"
+#include "jvs_protocol.h"
+#include "cpu_load.h"
+
+#define JVS_UART          uart0
+#define JVS_RX_RING_BITS  8  // 256-byte receive ring, 22 ms of back-to-back traffic
+
+typedef struct
+{
+  uint8_t button;  // Entry of _button_config (pico_hid.c)
+  uint8_t byte;    // 0: system byte, 1 + 2 * player + n: byte n of that player
+  uint8_t bit;     // JVS_SW_*
+} switch_map;
+
+// Switch configuration, player 1
+static const switch_map _jvs_switch_config[] = {
+    {4, 0, JVS_SW_TEST},   // Mode: test
+    {6, 1, JVS_SW_START},  // Start: player 1 start
+    {0, 1, JVS_SW_PUSH1},  // South: button 1
+    {1, 1, JVS_SW_PUSH2},  // East: button 2
+    {2, 2, JVS_SW_PUSH3},  // North: button 3
+    {3, 2, JVS_SW_PUSH4},  // West: button 4
+};
+
+// Coin switch of each slot (_button_config entry)
+static const uint8_t _jvs_coin_config[JVS_COIN_SLOTS] = {
+    5,  // Select: coin slot 1
+};
+
+// Player 1 switch of each stick direction
+static const uint8_t _jvs_stick_config[STICK_DIRECTIONS] = {
+    [STICK_LEFT] = JVS_SW_LEFT, [STICK_RIGHT] = JVS_SW_RIGHT, [STICK_UP] = JVS_SW_UP, [STICK_DOWN] = JVS_SW_DOWN,
+};
+
+// Stick axis of each analog channel (input_snapshot_t.axis)
+static const uint8_t _jvs_analog_config[JVS_ANALOG_CHANNELS] = { 0, 1 };  // Left stick X, Y
+
+//----------------------- Published Inputs -----------------------//
+// The main loop fills the buffer the poll is not reading and then flips the index. The poll
+// interrupts the main loop and never the other way round, so it always reads a complete buffer.
+static jvs_inputs published[2];
+static volatile uint8_t published_index;
+
+static uint32_t stick_directions;  // Bit per stick_direction (pico_hid.h)
+
+static uint32_t last_pressed;
+static uint16_t coin_presses[JVS_COIN_SLOTS];
+
+static void publish(const input_snapshot_t *input)
+{
+  jvs_inputs *next = &published[published_index ^ 1];
+  memset(next, 0, sizeof(*next));
+
+  stick_directions = input_stick_directions(input, stick_directions);
+  for (int d = 0; d < STICK_DIRECTIONS; d++)
+  {
+    if (stick_directions & (1u << d)) next->player[0][0] |= _jvs_stick_config[d];
+  }
+
+  for (unsigned i = 0; i < count_of(_jvs_switch_config); i++)
+  {
+    const switch_map *s = &_jvs_switch_config[i];
+    if (!(input->pressed & (1u << s->button))) continue;
+    if (s->byte == 0) next->system |= s->bit;
+    else next->player[(s->byte - 1) / JVS_SWITCH_BYTES][(s->byte - 1) % JVS_SWITCH_BYTES] |= s->bit;
+  }
+
+  uint32_t const down = input->pressed & ~last_pressed;
+  last_pressed = input->pressed;
+  for (int s = 0; s < JVS_COIN_SLOTS; s++)
+  {
+    if (down & (1u << _jvs_coin_config[s])) coin_presses[s]++;
+    next->coin_presses[s] = coin_presses[s];
+  }
+
+  for (int c = 0; c < JVS_ANALOG_CHANNELS; c++)
+  {
+    next->analog[c] = (uint16_t) (input->axis[_jvs_analog_config[c]] << (16 - JVS_ANALOG_BITS));
+  }
+
+  __compiler_memory_barrier();
+  published_index ^= 1;
+}
+
+void jvs_task(void)
+{
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input) publish(input);
+  cpu_load_exit();
+}
+
+//----------------------- Bus -----------------------//
+static uint8_t rx_ring[1u << JVS_RX_RING_BITS] __attribute__((aligned(1u << JVS_RX_RING_BITS)));
+static uint8_t rx_read;  // Next ring index to parse; wraps with the ring
+static int rx_chan = -1;
+static int tx_chan = -1;
+static bool transmitting;
+
+static int alarm_num = -1;
+static uint64_t target_us;
+static uint32_t last_poll_us;
+
+// Statistics for the telemetry page
+static uint32_t frames;
+static uint32_t replies;
+static uint32_t late_replies;     // Dropped, over JVS_REPLY_DEADLINE_US
+static uint32_t checksum_errors;
+static uint32_t busy_frames;      // Arrived while a reply was still going out
+static uint16_t latency_last_us;  // Upper bound, previous poll to reply start
+static uint16_t latency_max_us;
+
+static void frame_end(jvs_frame_result result)
+{
+  frames++;
+  if (result == JVS_FRAME_OTHER) return;
+  if (result == JVS_FRAME_CHECKSUM) checksum_errors++;
+  if (transmitting)  // Half duplex: the master does not talk while the board answers
+  {
+    busy_frames++;
+    return;
+  }
+
+  const uint8_t *frame;
+  uint16_t const len = jvs_reply(&published[published_index], &frame);
+  gpio_set_dir(JVS_SENSE_PIN, jvs_address() != 0);  // Pulled low by the output once addressed
+  if (!len) return;
+
+  uint32_t const latency = time_us_32() - last_poll_us;
+  if (latency > JVS_REPLY_DEADLINE_US)
+  {
+    late_replies++;
+    return;
+  }
+
+  gpio_put(JVS_DE_PIN, 1);
+  dma_channel_transfer_from_buffer_now(tx_chan, frame, len);
+  transmitting = true;
+  replies++;
+  latency_last_us = (uint16_t) latency;
+  if (latency_last_us > latency_max_us) latency_max_us = latency_last_us;
+}
+
+static void jvs_poll(uint alarm)
+{
+  cpu_load_enter();
+
+  // Release the bus once the last stop bit has left the shift register
+  if (transmitting && !dma_channel_is_busy(tx_chan) && !(uart_get_hw(JVS_UART)->fr & UART_UARTFR_BUSY_BITS))
+  {
+    gpio_put(JVS_DE_PIN, 0);
+    transmitting = false;
+  }
+
+  // The ring channel stops after UINT32_MAX bytes; restart it where it left off (the UART FIFO holds
+  // what arrives in between)
+  if (!dma_channel_is_busy(rx_chan)) dma_channel_set_trans_count(rx_chan, UINT32_MAX, true);
+
+  uint8_t const write = (uint8_t) ((uintptr_t) dma_channel_hw_addr(rx_chan)->write_addr - (uintptr_t) rx_ring);
+  while (rx_read != write)
+  {
+    jvs_frame_result const result = jvs_receive(rx_ring[rx_read++]);
+    if (result != JVS_FRAME_NONE) frame_end(result);
+  }
+  last_poll_us = time_us_32();
+
+  // Missed polls are skipped, the deadline check covers them
+  do target_us += JVS_POLL_US;
+  while (hardware_alarm_set_target(alarm, from_us_since_boot(target_us)));
+  cpu_load_exit();
+}
+
+void jvs_init(void)
+{
+  jvs_protocol_reset();
+
+  gpio_init(JVS_DE_PIN);
+  gpio_set_dir(JVS_DE_PIN, GPIO_OUT);
+  gpio_put(JVS_DE_PIN, 0);
+  gpio_init(JVS_SENSE_PIN);  // Input (released) until addressed, then driven low
+  gpio_put(JVS_SENSE_PIN, 0);
+
+  // stdio and the board support use UART0 on GPIO 0/1 too. Keep their output off the bus and stop
+  // GPIO 1 from feeding the UART as a second RX input.
+#if LIB_PICO_STDIO_UART
+  stdio_set_driver_enabled(&stdio_uart, false);
+#endif
+  gpio_set_function(PICO_DEFAULT_UART_TX_PIN, GPIO_FUNC_NULL);
+  gpio_set_function(PICO_DEFAULT_UART_RX_PIN, GPIO_FUNC_NULL);
+
+  uart_init(JVS_UART, JVS_BAUD);  // 8N1, FIFOs and DMA requests on
+  gpio_set_function(JVS_TX_PIN, GPIO_FUNC_UART);
+  gpio_set_function(JVS_RX_PIN, GPIO_FUNC_UART);
+
+  // Receive: UART data register into the ring, forever
+  rx_chan = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(rx_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, false);
+  channel_config_set_write_increment(&c, true);
+  channel_config_set_ring(&c, true, JVS_RX_RING_BITS);
+  channel_config_set_dreq(&c, uart_get_dreq(JVS_UART, false));
+  dma_channel_configure(rx_chan, &c, rx_ring, &uart_get_hw(JVS_UART)->dr, UINT32_MAX, true);
+
+  // Transmit: one reply into the UART data register, started by frame_end()
+  tx_chan = dma_claim_unused_channel(true);
+  c = dma_channel_get_default_config(tx_chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, uart_get_dreq(JVS_UART, true));
+  dma_channel_configure(tx_chan, &c, &uart_get_hw(JVS_UART)->dr, NULL, 0, false);
+
+  last_poll_us = time_us_32();
+  alarm_num = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(alarm_num, jvs_poll);
+  target_us = time_us_64() + JVS_POLL_US;
+  hardware_alarm_set_target(alarm_num, from_us_since_boot(target_us));
+}
+
+// Telemetry page: u8 address, u32 frames, u32 replies, u32 late replies, u32 checksum errors,
+// u32 frames while busy, u16 last latency (us), u16 longest latency (us)
+uint16_t jvs_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 25) return 0;
+
+  buf[0] = jvs_address();
+  memcpy(&buf[1], &frames, 4);
+  memcpy(&buf[5], &replies, 4);
+  memcpy(&buf[9], &late_replies, 4);
+  memcpy(&buf[13], &checksum_errors, 4);
+  memcpy(&buf[17], &busy_frames, 4);
+  memcpy(&buf[21], &latency_last_us, 2);
+  memcpy(&buf[23], &latency_max_us, 2);
+  return 25;
+}
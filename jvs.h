@@ -0,0 +1,61 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef JVS_H_
+#define JVS_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- JVS Personality -----------------------//
+// Makes the controller a JVS I/O board for an arcade game PCB, on UART0 through an RS-485 transceiver.
+// The protocol is in jvs_protocol.c.
+//
+// Both directions use DMA. One channel writes everything received into a 256-byte ring. Another sends
+// each reply, while the driver enable pin is high. A hardware alarm polls the ring every JVS_POLL_US in
+// its interrupt. The poll feeds the new bytes to the parser and answers a complete frame at once, so the
+// reply does not wait for the main loop.
+//
+// Replies are built from the inputs that jvs_task() publishes from the main loop. The last byte of a
+// request arrived after the previous poll, so the time since then is an upper bound on the reply
+// latency. It is measured for every reply. A reply whose bound is over JVS_REPLY_DEADLINE_US is
+// dropped instead of sent late, e.g. after interrupts were off for a flash write. The master then
+// retries instead of seeing a reply collide with its next request.
+//
+// The sense line is pulled low once the board has an address, so the master knows it is the last one in
+// the chain (no board behind it).
+#define JVS_TX_PIN            16     // UART0 TX to the transceiver's DI
+#define JVS_RX_PIN            17     // UART0 RX from the transceiver's RO
+#define JVS_DE_PIN            19     // Driver enable, DE and /RE tied together, high while transmitting
+#define JVS_SENSE_PIN         22     // Sense line to the master, low once addressed
+#define JVS_BAUD              115200
+#define JVS_POLL_US           100    // About one byte time at 115200 baud
+#define JVS_REPLY_DEADLINE_US 1000
+
+void jvs_init(void);
+void jvs_task(void);
+uint16_t jvs_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* JVS_H_ */
@@ -0,0 +1,323 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "jvs_protocol.h"
+
+// Identification (command 0x10): maker; product; version; comment
+static const char jvs_id[] = "DIY;PICO GAME CONTROLLER;VER1.00;RP2040 JVS I/O";
+
+static uint8_t address;  // 0 until the master assigns one
+
+//----------------------- Receive -----------------------//
+typedef enum { RX_IDLE, RX_NODE, RX_LENGTH, RX_DATA } rx_state_t;
+
+static rx_state_t rx_state;
+static bool rx_escape;
+static uint8_t rx_node;
+static uint8_t rx_length;
+static uint8_t rx_count;
+static uint8_t rx_sum;
+static uint8_t rx_data[JVS_DATA_MAX + 1];  // Data and checksum
+static jvs_frame_result rx_result;
+
+void jvs_protocol_reset(void)
+{
+  address = 0;
+  rx_state = RX_IDLE;
+  rx_result = JVS_FRAME_NONE;
+}
+
+uint8_t jvs_address(void)
+{
+  return address;
+}
+
+// A SYNC byte always starts a new frame, so a corrupted or cut frame is dropped at the next one
+jvs_frame_result jvs_receive(uint8_t byte)
+{
+  if (byte == JVS_SYNC)
+  {
+    rx_state = RX_NODE;
+    rx_escape = false;
+    return JVS_FRAME_NONE;
+  }
+  if (rx_state == RX_IDLE) return JVS_FRAME_NONE;
+  if (byte == JVS_MARK)
+  {
+    rx_escape = true;
+    return JVS_FRAME_NONE;
+  }
+  if (rx_escape)
+  {
+    byte++;
+    rx_escape = false;
+  }
+
+  switch (rx_state)
+  {
+    case RX_NODE:
+      rx_node = byte;
+      rx_sum = byte;
+      rx_state = RX_LENGTH;
+      return JVS_FRAME_NONE;
+
+    case RX_LENGTH:
+      rx_length = byte;
+      rx_sum += byte;
+      rx_count = 0;
+      rx_state = byte ? RX_DATA : RX_IDLE;
+      return JVS_FRAME_NONE;
+
+    default:
+      rx_data[rx_count++] = byte;
+      if (rx_count < rx_length)
+      {
+        rx_sum += byte;
+        return JVS_FRAME_NONE;
+      }
+      rx_state = RX_IDLE;
+      break;
+  }
+
+  // Node 0 is the master: the replies of other boards pass by while this one is unaddressed
+  if (rx_node != JVS_NODE_BROADCAST && (address == 0 || rx_node != address)) rx_result = JVS_FRAME_OTHER;
+  else rx_result = rx_sum == byte ? JVS_FRAME_OK : JVS_FRAME_CHECKSUM;
+  return rx_result;
+}
+
+//----------------------- Transmit -----------------------//
+static uint16_t put_escaped(uint8_t *out, uint16_t n, uint8_t byte)
+{
+  if (byte == JVS_SYNC || byte == JVS_MARK)
+  {
+    out[n++] = JVS_MARK;
+    byte--;
+  }
+  out[n++] = byte;
+  return n;
+}
+
+// Writes the wire form of a frame (at most JVS_WIRE_MAX bytes) and returns its length
+uint16_t jvs_encode(uint8_t node, const uint8_t *data, uint16_t len, uint8_t *out)
+{
+  uint8_t const length = (uint8_t) (len + 1);
+  uint8_t sum = (uint8_t) (node + length);
+  uint16_t n = 0;
+
+  out[n++] = JVS_SYNC;
+  n = put_escaped(out, n, node);
+  n = put_escaped(out, n, length);
+  for (uint16_t i = 0; i < len; i++)
+  {
+    n = put_escaped(out, n, data[i]);
+    sum += data[i];
+  }
+  return put_escaped(out, n, sum);
+}
+
+//----------------------- Commands -----------------------//
+static uint8_t reply[JVS_DATA_MAX];
+static uint16_t reply_len;
+static bool reply_overflow;
+
+static uint8_t wire[JVS_WIRE_MAX];  // Last reply as sent, kept for JVS_CMD_RETRANSMIT
+static uint16_t wire_len;
+
+static uint16_t coins[JVS_COIN_SLOTS];
+static uint16_t coin_presses_seen[JVS_COIN_SLOTS];
+
+static void put(uint8_t byte)
+{
+  if (reply_len < sizeof(reply)) reply[reply_len++] = byte;
+  else reply_overflow = true;
+}
+
+static void put16(uint16_t value)
+{
+  put((uint8_t) (value >> 8));
+  put((uint8_t) value);
+}
+
+static void put_features(void)
+{
+  put(0x01); put(JVS_PLAYERS); put(JVS_SWITCHES); put(0);            // Switch inputs
+  put(0x02); put(JVS_COIN_SLOTS); put(0); put(0);                    // Coin slots
+  put(0x03); put(JVS_ANALOG_CHANNELS); put(JVS_ANALOG_BITS); put(0); // Analog inputs
+  put(0x00);
+}
+
+// Coin switch presses land in the counters when a reply is built, so the counters only ever change
+// here and in the coin commands
+static void count_coins(const jvs_inputs *inputs)
+{
+  for (int s = 0; s < JVS_COIN_SLOTS; s++)
+  {
+    uint16_t const added = (uint16_t) (inputs->coin_presses[s] - coin_presses_seen[s]);
+    coin_presses_seen[s] = inputs->coin_presses[s];
+    coins[s] = coins[s] + added > JVS_COIN_MAX ? JVS_COIN_MAX : (uint16_t) (coins[s] + added);
+  }
+}
+
+static void coin_adjust(uint8_t slot, uint16_t count, bool add)
+{
+  if (slot == 0 || slot > JVS_COIN_SLOTS) return;  // Slots count from 1
+  uint16_t *c = &coins[slot - 1];
+  if (add) *c = *c + count > JVS_COIN_MAX ? JVS_COIN_MAX : (uint16_t) (*c + count);
+  else *c = count > *c ? 0 : (uint16_t) (*c - count);
+}
+
+// Runs the command at `cmd` (`avail` bytes left in the frame) and returns the bytes it used,
+// 0 for an unknown or cut off command
+static uint16_t command(const uint8_t *cmd, uint16_t avail, const jvs_inputs *inputs)
+{
+  switch (cmd[0])
+  {
+    case JVS_CMD_ID:
+      put(JVS_REPORT_NORMAL);
+      for (unsigned i = 0; i < sizeof(jvs_id); i++) put((uint8_t) jvs_id[i]);  // Including the NUL
+      return 1;
+
+    case JVS_CMD_CMD_REVISION: put(JVS_REPORT_NORMAL); put(0x13); return 1;  // 1.3
+    case JVS_CMD_JVS_REVISION: put(JVS_REPORT_NORMAL); put(0x30); return 1;  // 3.0
+    case JVS_CMD_COMM_VERSION: put(JVS_REPORT_NORMAL); put(0x10); return 1;  // 1.0
+
+    case JVS_CMD_FEATURES:
+      put(JVS_REPORT_NORMAL);
+      put_features();
+      return 1;
+
+    case JVS_CMD_MAIN_ID:
+    {
+      const uint8_t *end = memchr(cmd + 1, 0, avail - 1u);
+      if (!end) return 0;
+      put(JVS_REPORT_NORMAL);
+      return (uint16_t) (end - cmd + 1);
+    }
+
+    case JVS_CMD_SWITCHES:
+    {
+      if (avail < 3) return 0;
+      put(JVS_REPORT_NORMAL);
+      put(inputs->system);
+      for (int p = 0; p < cmd[1]; p++)
+      {
+        for (int b = 0; b < cmd[2]; b++) put(p < JVS_PLAYERS && b < JVS_SWITCH_BYTES ? inputs->player[p][b] : 0);
+      }
+      return 3;
+    }
+
+    case JVS_CMD_COINS:
+      if (avail < 2) return 0;
+      put(JVS_REPORT_NORMAL);
+      for (int s = 0; s < cmd[1]; s++) put16(s < JVS_COIN_SLOTS ? coins[s] : 0);  // Status 0 (normal) in the top bits
+      return 2;
+
+    case JVS_CMD_ANALOG:
+      if (avail < 2) return 0;
+      put(JVS_REPORT_NORMAL);
+      for (int c = 0; c < cmd[1]; c++) put16(c < JVS_ANALOG_CHANNELS ? inputs->analog[c] : 0);
+      return 2;
+
+    case JVS_CMD_COIN_DECREASE:
+    case JVS_CMD_COIN_INCREASE:
+      if (avail < 4) return 0;
+      coin_adjust(cmd[1], (uint16_t) (cmd[2] << 8 | cmd[3]), cmd[0] == JVS_CMD_COIN_INCREASE);
+      put(JVS_REPORT_NORMAL);
+      return 4;
+
+    default:
+      return 0;
+  }
+}
+
+// Broadcast frames only carry reset and address assignment; the address goes to an unaddressed board
+static bool broadcast(const uint8_t *data, uint16_t len)
+{
+  if (len >= 2 && data[0] == JVS_CMD_RESET && data[1] == JVS_RESET_ARG)
+  {
+    address = 0;
+    return false;
+  }
+  if (len >= 2 && data[0] == JVS_CMD_SET_ADDRESS && address == 0 && data[1] != 0 && data[1] != JVS_NODE_BROADCAST)
+  {
+    address = data[1];
+    put(JVS_REPORT_NORMAL);
+    return true;
+  }
+  return false;
+}
+
+// Builds the reply to the frame jvs_receive() just completed. Returns its wire length and points
+// `frame` at it, or returns 0 if the frame gets no reply. The frame stays valid until the next call.
+uint16_t jvs_reply(const jvs_inputs *inputs, const uint8_t **frame)
+{
+  jvs_frame_result const result = rx_result;
+  rx_result = JVS_FRAME_NONE;
+  *frame = wire;
+
+  if (result == JVS_FRAME_NONE || result == JVS_FRAME_OTHER) return 0;
+
+  uint16_t const len = (uint16_t) (rx_length - 1);  // Without the checksum
+  if (result == JVS_FRAME_OK && len >= 1 && rx_data[0] == JVS_CMD_RETRANSMIT && rx_node != JVS_NODE_BROADCAST)
+  {
+    return wire_len;
+  }
+
+  reply_len = 0;
+  reply_overflow = false;
+  put(JVS_STATUS_NORMAL);
+
+  if (rx_node == JVS_NODE_BROADCAST)
+  {
+    if (result != JVS_FRAME_OK || !broadcast(rx_data, len)) return 0;
+  }
+  else if (result == JVS_FRAME_CHECKSUM)
+  {
+    reply[0] = JVS_STATUS_CHECKSUM;
+  }
+  else
+  {
+    count_coins(inputs);
+    for (uint16_t i = 0; i < len;)
+    {
+      uint16_t const used = command(&rx_data[i], (uint16_t) (len - i), inputs);
+      if (!used)
+      {
+        reply[0] = JVS_STATUS_UNKNOWN;
+        break;
+      }
+      i += used;
+    }
+    if (reply_overflow)
+    {
+      reply[0] = JVS_STATUS_OVERFLOW;
+      reply_len = 1;
+    }
+  }
+
+  wire_len = jvs_encode(JVS_NODE_MASTER, reply, reply_len, wire);
+  return wire_len;
+}
@@ -0,0 +1,118 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef JVS_PROTOCOL_H_
+#define JVS_PROTOCOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//----------------------- JVS Protocol -----------------------//
+// The I/O board side of JVS, the arcade I/O protocol, without any hardware access, so the host
+// simulator (tools/jvs_sim.c) runs the same code as the firmware (jvs.c).
+//
+// A frame is SYNC, node, length, data and a checksum (the sum of node, length and data). The length
+// counts the data and the checksum. SYNC and MARK bytes inside a frame go out as MARK followed by the
+// byte minus one. The master (node 0) sends one or more commands per frame. The board answers every
+// frame addressed to it with one frame: a status byte, then one report per command. Node 0xFF is the
+// broadcast used for reset and address assignment; only an unaddressed board takes the next address.
+#define JVS_SYNC              0xE0
+#define JVS_MARK              0xD0
+#define JVS_NODE_MASTER       0x00
+#define JVS_NODE_BROADCAST    0xFF
+#define JVS_DATA_MAX          254   // Data bytes per frame, the length byte also counts the checksum
+#define JVS_WIRE_MAX          (3 + 2 * (JVS_DATA_MAX + 1))  // Encoded frame, every byte escaped
+
+// Commands
+#define JVS_CMD_RESET         0xF0  // + 0xD9, broadcast, no reply
+#define JVS_CMD_SET_ADDRESS   0xF1  // + address, broadcast
+#define JVS_CMD_ID            0x10
+#define JVS_CMD_CMD_REVISION  0x11
+#define JVS_CMD_JVS_REVISION  0x12
+#define JVS_CMD_COMM_VERSION  0x13
+#define JVS_CMD_FEATURES      0x14
+#define JVS_CMD_MAIN_ID       0x15  // + NUL-terminated string
+#define JVS_CMD_SWITCHES      0x20  // + players, bytes per player
+#define JVS_CMD_COINS         0x21  // + slots
+#define JVS_CMD_ANALOG        0x22  // + channels
+#define JVS_CMD_RETRANSMIT    0x2F
+#define JVS_CMD_COIN_DECREASE 0x30  // + slot, count (big-endian)
+#define JVS_CMD_COIN_INCREASE 0x35  // + slot, count (big-endian)
+
+#define JVS_RESET_ARG         0xD9
+
+// Frame status and per-command report codes
+#define JVS_STATUS_NORMAL     0x01
+#define JVS_STATUS_UNKNOWN    0x02  // Unknown command, the rest of the frame is skipped
+#define JVS_STATUS_CHECKSUM   0x03
+#define JVS_STATUS_OVERFLOW   0x04  // Reply would not fit in a frame
+#define JVS_REPORT_NORMAL     0x01
+
+// What the board offers (feature check)
+#define JVS_PLAYERS           1
+#define JVS_SWITCHES          13    // Per player: start, service, 4 directions, 7 push buttons
+#define JVS_SWITCH_BYTES      2     // Per player
+#define JVS_COIN_SLOTS        1
+#define JVS_ANALOG_CHANNELS   2
+#define JVS_ANALOG_BITS       12    // Significant bits; values are left aligned to 16 bits
+#define JVS_COIN_MAX          0x3FFF
+
+// Player switch bits, byte 0 (the system byte only has TEST in bit 7)
+#define JVS_SW_TEST           0x80
+#define JVS_SW_START          0x80
+#define JVS_SW_SERVICE        0x40
+#define JVS_SW_UP             0x20
+#define JVS_SW_DOWN           0x10
+#define JVS_SW_LEFT           0x08
+#define JVS_SW_RIGHT          0x04
+#define JVS_SW_PUSH1          0x02
+#define JVS_SW_PUSH2          0x01
+#define JVS_SW_PUSH3          0x80  // Player byte 1
+#define JVS_SW_PUSH4          0x40
+
+// Inputs a reply is built from
+typedef struct
+{
+  uint8_t system;                                        // JVS_SW_TEST
+  uint8_t player[JVS_PLAYERS][JVS_SWITCH_BYTES];
+  uint16_t analog[JVS_ANALOG_CHANNELS];                  // Left aligned
+  uint16_t coin_presses[JVS_COIN_SLOTS];                 // Coin switch presses since boot, wraps
+} jvs_inputs;
+
+typedef enum
+{
+  JVS_FRAME_NONE = 0,   // Frame not complete yet
+  JVS_FRAME_OK,         // Complete frame for this board (or broadcast)
+  JVS_FRAME_CHECKSUM,   // Complete frame for this board with a bad checksum
+  JVS_FRAME_OTHER,      // Complete frame for another node, including the replies of other boards
+} jvs_frame_result;
+
+void jvs_protocol_reset(void);
+jvs_frame_result jvs_receive(uint8_t byte);
+uint16_t jvs_reply(const jvs_inputs *inputs, const uint8_t **frame);
+uint16_t jvs_encode(uint8_t node, const uint8_t *data, uint16_t len, uint8_t *out);
+uint8_t jvs_address(void);
+
+#endif /* JVS_PROTOCOL_H_ */
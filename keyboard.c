@@ -0,0 +1,82 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "pico/stdlib.h"
+#include "keyboard.h"
+#include "cpu_load.h"
+
+typedef enum
+{
+  KEY_SRC_BUTTON,  // Entry of _button_config (pico_hid.c), physical or virtual
+  KEY_SRC_STICK,   // Left stick direction (stick_direction, pico_hid.h)
+} key_source_kind;
+
+typedef struct
+{
+  key_source_kind source;
+  uint8_t index;    // Button entry or stick direction
+  uint8_t keycode;  // HID_KEY_*
+} key_map;
+
+// Key configuration, MAME's default player 1 keys
+static const key_map _keyboard_config[] = {
+    {KEY_SRC_STICK, STICK_LEFT, HID_KEY_ARROW_LEFT},
+    {KEY_SRC_STICK, STICK_RIGHT, HID_KEY_ARROW_RIGHT},
+    {KEY_SRC_STICK, STICK_UP, HID_KEY_ARROW_UP},
+    {KEY_SRC_STICK, STICK_DOWN, HID_KEY_ARROW_DOWN},
+    {KEY_SRC_BUTTON, 0, HID_KEY_CONTROL_LEFT},  // South: button 1
+    {KEY_SRC_BUTTON, 1, HID_KEY_ALT_LEFT},      // East: button 2
+    {KEY_SRC_BUTTON, 2, HID_KEY_SPACE},         // North: button 3
+    {KEY_SRC_BUTTON, 3, HID_KEY_SHIFT_LEFT},    // West: button 4
+    {KEY_SRC_BUTTON, 4, HID_KEY_TAB},           // Mode: emulator menu
+    {KEY_SRC_BUTTON, 5, HID_KEY_5},             // Select: coin 1
+    {KEY_SRC_BUTTON, 6, HID_KEY_1},             // Start: player 1 start
+};
+
+//----------------------- Report -----------------------//
+static uint32_t stick_keys;  // Left stick directions of the last report, bit per stick_direction
+
+static void set_key(hid_nkro_report_t *report, uint8_t keycode)
+{
+  if (keycode >= HID_KEY_CONTROL_LEFT) report->modifiers |= (uint8_t) (1u << (keycode - HID_KEY_CONTROL_LEFT));
+  else if (keycode < KEYBOARD_NKRO_KEYS) report->keys[keycode >> 3] |= (uint8_t) (1u << (keycode & 7));
+}
+
+void keyboard_update_report(hid_nkro_report_t *report)
+{
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input)
+  {
+    stick_keys = input_stick_directions(input, stick_keys);
+    for (unsigned i = 0; i < count_of(_keyboard_config); i++)
+    {
+      const key_map *k = &_keyboard_config[i];
+      uint32_t const state = k->source == KEY_SRC_BUTTON ? input->pressed : stick_keys;
+      if (state & (1u << k->index)) set_key(report, k->keycode);
+    }
+  }
+  cpu_load_exit();
+}
@@ -0,0 +1,51 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef KEYBOARD_H_
+#define KEYBOARD_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- Keyboard Personality -----------------------//
+// Presents the panel as a keyboard for PC emulators (MAME and the like): every button and the four stick
+// directions map to a keycode (_keyboard_config in keyboard.c). The report is an N-key-rollover bitmap,
+// one bit per keycode, so any number of inputs can be down at once; the 6-key boot array would drop
+// presses past the sixth. It is built from the same debounced snapshot as the gamepad report and
+// sent on change at the report rate.
+//
+// Keycodes 0xE0-0xE7 (Control, Shift, Alt, GUI) go into the modifier byte, all others below
+// KEYBOARD_NKRO_KEYS into the bitmap. There is no boot protocol: a BIOS setup screen will not see it.
+#define KEYBOARD_NKRO_KEYS 128  // Keycodes 0x00-0x7F, letters, digits, F-keys, arrows and keypad
+
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t modifiers;                      // Bit n = keycode 0xE0 + n
+  uint8_t keys[KEYBOARD_NKRO_KEYS / 8];   // Bit n of byte k = keycode 8 * k + n
+} hid_nkro_report_t;
+
+void keyboard_update_report(hid_nkro_report_t *report);
+
+#endif /* KEYBOARD_H_ */
@@ -29,10 +29,26 @@
 #include "tusb.h"
 #include <pico/stdlib.h>
 #include "pico_hid.h"
+#include "mem_budget.h"
+#include "boot_profile.h"
+#include "supervisor.h"
 
 #ifndef JUST_STDIO
 #include "bsp/board.h"
 #include "usb_descriptors.h"
+#include "telemetry.h"
+#include "fw_update.h"
+#include "calibration.h"
+#include "axis_health.h"
+#include "button_stats.h"
+#include "periodic.h"
+#include "personality.h"
+#include "wheel.h"
+#include "keyboard.h"
+#include "mouse.h"
+#include "switch_pad.h"
+#include "midi.h"
+#include "jvs.h"
 #endif
 
 //--------------------------------------------------------------------+
@@ -58,12 +74,29 @@ enum  {
 
 static uint32_t blink_interval_ms = BLINK_NOT_MOUNTED;  // Start with not mounted state
 
+// Periodic tasks of the superloop (see periodic.h)
+#define HID_REPORT_INTERVAL_US 1000  // 1 kHz, matching the 1 ms interrupt endpoint interval
+static periodic_task hid_period;  // Skips missed report slots: a stall never produces a burst of reports
+static periodic_task led_period;  // Re-phases after a stall or a blink pattern change
+
+// Set by tud_mount_cb(): the host has no input state yet, so the next report is sent straight away
+// from the (already warm) input snapshot instead of waiting for the next report interval.
+static volatile bool mount_report_pending = false;
+
+// When the last gamepad report was queued; its completion gives the host's poll phase for the predictor
+static uint32_t report_queued_us = 0;
+
+// Software re-enumeration requested over telemetry: disconnect, wait, reconnect
+#define REENUMERATE_DISCONNECT_MS 100
+static uint32_t reenumerate_at_ms = 0;  // 0 = no reconnect pending
+
 // Define GPIO for external LED - Hardware Components (Output Devices)
 // This GPIO pin will control an external LED to visually represent the state of the device.
 #define LED_GPIO 18  // External LED connected to GPIO 18
 
 void led_blinking_task(void);  // Task to control the blinking LED
 void hid_task(void);           // Task to handle USB HID (Human Interface Device)
+void usb_command_task(void);   // Task to run USB commands requested over telemetry
 
 /*------------- MAIN -------------*/
 /* Digital Systems Architecture & Components of Digital Systems
@@ -71,12 +104,23 @@ void hid_task(void);           // Task to handle USB HID (Human Interface Device
  * (GPIO pins, USB subsystem) and enters an infinite loop where it continuously performs tasks 
  * such as handling USB communication (via `tusb_init` and `tud_task`), reading input from 
  * buttons, and controlling output devices (LED).
+ *
+ * Boot order matters for time-to-first-report: the USB stack is started before anything else so
+ * the host can begin enumerating, and slower setup (the ADC) is deferred into input_task(), which
+ * runs while enumeration is in progress and has a valid snapshot ready before tud_mount_cb() fires.
  */
 int main(void)
 {
+  supervisor_init();   // Pick up the hang diagnostics of the previous run before anything else
+  stack_paint_init();  // Fill the unused stack with a pattern so its high-water mark can be measured
+  boot_profile_mark(BOOT_MARK_MAIN);
+
   #ifndef JUST_STDIO
+  fw_update_init();  // Find out which firmware slot we run from and whether it is on trial
+  personality_init();  // The button held at power-up picks the USB personality, so before tusb_init()
   board_init();   // Initialize the board-specific hardware, such as setting up clocks and peripherals
   tusb_init();    // Initialize TinyUSB stack to handle USB communication
+  boot_profile_mark(BOOT_MARK_USB_INIT);
   #else
   stdio_init_all();  // Initialize the standard input/output (used in environments without TinyUSB)
   printf("Starting up");
@@ -84,18 +128,51 @@ int main(void)
 
   // Setting up Input Devices (buttons and joystick)
   setup_controller_buttons();  // Configure the buttons and joystick as input devices
+  #ifndef JUST_STDIO
+  if (personality() == PERSONALITY_WHEEL) wheel_init();  // Start the encoder counter, center the wheel
+  if (personality() == PERSONALITY_MOUSE) mouse_init();  // Start the trackball counters
+  if (personality() == PERSONALITY_JVS) jvs_init();      // Start the RS-485 bus, replies come from its alarm
+  #endif
 
   // Initialize GPIO 18 for external LED as an output device - Output Device Interaction
   gpio_init(LED_GPIO);         // Initialize GPIO pin 18
   gpio_set_dir(LED_GPIO, GPIO_OUT);  // Set GPIO 18 as an output pin to control an external LED
 
+  periodic_init(&hid_period, HID_REPORT_INTERVAL_US, PERIODIC_SKIP);
+  periodic_init(&led_period, blink_interval_ms * 1000, PERIODIC_REPHASE);
+
+  // Arm the hang watchdog; from here on every loop iteration must produce a fresh input sample
+  supervisor_start();
+
   // Infinite loop to continuously process USB and gamepad tasks
   while (1)
   {
     #ifndef JUST_STDIO
+    supervisor_stage_enter(SUPERVISOR_STAGE_TUD_TASK);
+    stack_probe_begin(STACK_SLOT_TUD_TASK);
     tud_task(); // TinyUSB device task (handles USB requests from the host) - Networks/USB Communication
+    stack_probe_end(STACK_SLOT_TUD_TASK);
+
+    supervisor_stage_enter(SUPERVISOR_STAGE_INPUT_TASK);
+    stack_probe_begin(STACK_SLOT_INPUT_TASK);
+    input_task();  // Start the sampling scheduler on the first call, then run its housekeeping (drift, flash saves)
+    stack_probe_end(STACK_SLOT_INPUT_TASK);
+
+    supervisor_stage_enter(SUPERVISOR_STAGE_LED_TASK);
+    stack_probe_begin(STACK_SLOT_LED_TASK);
     led_blinking_task();  // Task to control the LED blinking pattern (device feedback via output device)
+    stack_probe_end(STACK_SLOT_LED_TASK);
+
+    supervisor_stage_enter(SUPERVISOR_STAGE_HID_TASK);
+    stack_probe_begin(STACK_SLOT_HID_TASK);
     hid_task();  // Task to handle Human Interface Device (HID) report generation and transmission
+    stack_probe_end(STACK_SLOT_HID_TASK);
+
+    supervisor_stage_enter(SUPERVISOR_STAGE_USB_COMMAND);
+    usb_command_task();  // Host-requested actions such as a simulated re-enumeration
+
+    supervisor_stage_enter(SUPERVISOR_STAGE_FW_UPDATE);
+    fw_update_task();    // Erase / verify / activate steps of a firmware update, trial boot confirmation
     #else
 
     /* Input Devices
@@ -117,11 +194,15 @@ int main(void)
     };
     
     // Update the HID report with the latest input (buttons, joysticks)
+    input_task();
     update_hid_report_controller(&report);
 
     // Print the current state of the D-pad (hat switch) and buttons for debugging purposes
     printf("hat: %d buttons: %d\n", report.hat, report.buttons);  // Output to console (output device)
     #endif
+
+    // Feed the watchdog only if the loop got all the way round with a new input sample
+    supervisor_progress(input_snapshot()->sample_us);
   }
 
   return 0;  // This return is never reached since the while loop runs infinitely
@@ -138,6 +219,9 @@ int main(void)
  */
 void tud_mount_cb(void)
 {
+  boot_profile_mark(BOOT_MARK_MOUNT);
+  boot_profile_mounted();             // Start timing the mount-to-first-report gap
+  mount_report_pending = true;        // Send the first report as soon as the endpoint is ready
   blink_interval_ms = BLINK_MOUNTED;  // Change blink pattern to mounted state (1000ms interval)
 }
 
@@ -145,9 +229,11 @@ void tud_mount_cb(void)
  * USB Protocol
  * When the USB connection is lost or the device is disconnected, this callback is triggered.
  * The system will return to the "not mounted" state, and the LED blink pattern will reflect this.
+ * Input sampling and conditioning keep running, so nothing needs to be reset here.
  */
 void tud_umount_cb(void)
 {
+  mount_report_pending = false;
   blink_interval_ms = BLINK_NOT_MOUNTED;  // Set blink pattern to unmounted state (250ms interval)
 }
 
@@ -177,6 +263,37 @@ void tud_resume_cb(void)
 
 #ifndef JUST_STDIO
 
+// Input report of the boot personality
+static uint8_t input_report_id(void)
+{
+  switch (personality())
+  {
+    case PERSONALITY_WHEEL:    return REPORT_ID_WHEEL;
+    case PERSONALITY_KEYBOARD: return REPORT_ID_KEYBOARD;
+    case PERSONALITY_MOUSE:    return REPORT_ID_MOUSE;
+    case PERSONALITY_SWITCH:   return REPORT_ID_SWITCH;
+    default:                   return REPORT_ID_GAMEPAD;
+  }
+}
+
+// Queues an input report only when it differs from the last one the host got (the host keeps the
+// previous state), or unconditionally right after mount so the host starts from the current state.
+// Returns true if the report was queued.
+static bool send_input_report(uint8_t report_id, void const *report, void *last_report, uint16_t len)
+{
+  if ( mount_report_pending || memcmp(report, last_report, len) != 0 )
+  {
+    if ( !tud_hid_report(report_id, report, len) ) return false;  // Endpoint busy, retry next poll
+    memcpy(last_report, report, len);
+    report_queued_us = time_us_32();
+    boot_profile_mark(BOOT_MARK_FIRST_REPORT);
+    if (mount_report_pending) boot_profile_first_report();
+    mount_report_pending = false;
+    return true;
+  }
+  return false;
+}
+
 /* Input Devices and USB Communication
  * This function prepares and sends a HID report to the host (e.g., a PC) to communicate the 
  * current state of the gamepad (buttons, joystick positions). HID reports are the standard 
@@ -192,7 +309,7 @@ static void send_hid_report(uint8_t report_id, uint32_t btn)
     case REPORT_ID_GAMEPAD:  // Handle gamepad reports
     {
       // Ensure we avoid sending multiple consecutive zero reports
-      static bool has_gamepad_key = false;
+      static hid_gamepad_report_t last_report;  // Last report the host accepted
 
       // Create an empty HID report for the gamepad
       hid_gamepad_report_t report =
@@ -209,19 +326,54 @@ static void send_hid_report(uint8_t report_id, uint32_t btn)
 
       // Update the HID report with current button and joystick states
       update_hid_report_controller(&report);
+      send_input_report(REPORT_ID_GAMEPAD, &report, &last_report, sizeof(report));
+    }
+    break;
 
-      // Send the report if there is any input
-      if ( !is_empty(&report) )
-      {
-        tud_hid_report(REPORT_ID_GAMEPAD, &report, sizeof(report));  // Send the report via USB
-        has_gamepad_key = true;  // Mark that we have active input
-      }
-      else if (has_gamepad_key)
+    case REPORT_ID_WHEEL:  // Wheel personality
+    {
+      static hid_wheel_report_t last_report;
+      hid_wheel_report_t report = { .steering = WHEEL_STEERING_CENTER };
+
+      wheel_update_report(&report);
+      send_input_report(REPORT_ID_WHEEL, &report, &last_report, sizeof(report));
+    }
+    break;
+
+    case REPORT_ID_KEYBOARD:  // Keyboard personality
+    {
+      static hid_nkro_report_t last_report;
+      hid_nkro_report_t report = { 0 };
+
+      keyboard_update_report(&report);
+      send_input_report(REPORT_ID_KEYBOARD, &report, &last_report, sizeof(report));
+    }
+    break;
+
+    case REPORT_ID_MOUSE:  // Mouse personality
+    {
+      // Deltas are relative: the host only keeps the buttons, so the last report is compared without them
+      static hid_mouse16_report_t last_report;
+      hid_mouse16_report_t report = { 0 };
+
+      mouse_update_report(&report);
+      if (send_input_report(REPORT_ID_MOUSE, &report, &last_report, sizeof(report))) mouse_report_sent(&report);
+      last_report.x = last_report.y = 0;
+    }
+    break;
+
+    case REPORT_ID_SWITCH:  // Switch personality
+    {
+      static hid_switch_report_t last_report;
+      hid_switch_report_t report =
       {
-        // If previously active but no input now, send a zeroed report to "release" buttons
-        tud_hid_report(REPORT_ID_GAMEPAD, &report, sizeof(report));
-        has_gamepad_key = false;  // No longer has active input
-      }
+        .hat = SWITCH_HAT_NEUTRAL,
+        .lx = SWITCH_STICK_CENTER, .ly = SWITCH_STICK_CENTER,
+        .rx = SWITCH_STICK_CENTER, .ry = SWITCH_STICK_CENTER,
+      };
+
+      switch_pad_update_report(&report);
+      send_input_report(REPORT_ID_SWITCH, &report, &last_report, sizeof(report));
     }
     break;
 
@@ -230,18 +382,36 @@ static void send_hid_report(uint8_t report_id, uint32_t btn)
 }
 
 /* USB Communication
- * This function is called every 10ms to send a HID report to the host. The regular polling interval
+ * This function is called every 1 ms to send a HID report to the host. The regular polling interval
  * ensures that the host receives timely updates on the state of the gamepad, even if the user
  * doesn't interact with it frequently. The system continuously monitors input devices and updates
- * the HID report accordingly.
+ * the HID report accordingly. If the loop stalls (e.g. a long control transfer in tud_task), the
+ * missed 1 ms slots are skipped rather than sent back to back.
  */
 void hid_task(void)
 {
-  const uint32_t interval_ms = 10;  // Polling interval for HID reports (every 10ms)
-  static uint32_t start_ms = 0;
+  // The MIDI personality has no input report; its events leave as soon as they are captured
+  if ( personality() == PERSONALITY_MIDI )
+  {
+    midi_task();
+    return;
+  }
 
-  if ( board_millis() - start_ms < interval_ms ) return;  // Ensure enough time has passed before the next report
-  start_ms += interval_ms;
+  // The JVS personality answers its master from an interrupt; the loop only publishes the inputs
+  if ( personality() == PERSONALITY_JVS )
+  {
+    jvs_task();
+    return;
+  }
+
+  // First report after (re-)mount goes out immediately from the warm snapshot
+  if ( mount_report_pending )
+  {
+    send_hid_report(input_report_id(), 0);
+    return;
+  }
+
+  if ( !periodic_due(&hid_period) ) return;  // Ensure enough time has passed before the next report (HID_REPORT_INTERVAL_US)
 
   uint32_t const btn = board_button_read();  // Read the state of the buttons (Input Device interaction)
 
@@ -252,7 +422,37 @@ void hid_task(void)
   }
   else
   {
-    send_hid_report(REPORT_ID_GAMEPAD, btn);  // Send the gamepad report to the host
+    send_hid_report(input_report_id(), btn);  // Send the gamepad (or other personality's) report to the host
+  }
+}
+
+/* USB Communication
+ * Runs actions requested by the host through the telemetry feature report. They cannot run inside
+ * the control transfer callback, which must complete before the bus is touched.
+ * A simulated re-enumeration detaches from the bus, waits REENUMERATE_DISCONNECT_MS and reattaches;
+ * the host then sees a full unmount/mount cycle and the mount-to-first-report gap is recorded.
+ */
+void usb_command_task(void)
+{
+  switch (telemetry_take_command())
+  {
+    case TELEMETRY_CMD_REENUMERATE:
+      tud_disconnect();
+      reenumerate_at_ms = board_millis() + REENUMERATE_DISCONNECT_MS;
+      if (!reenumerate_at_ms) reenumerate_at_ms = 1;
+      break;
+
+    case TELEMETRY_CMD_HEALTH_RESET:
+      axis_health_reset();
+      break;
+
+    default: break;
+  }
+
+  if ( reenumerate_at_ms && (int32_t) (board_millis() - reenumerate_at_ms) >= 0 )
+  {
+    reenumerate_at_ms = 0;
+    tud_connect();
   }
 }
 
@@ -262,25 +462,49 @@ void tud_hid_report_complete_cb(uint8_t instance, uint8_t const* report, uint16_
   (void) instance;
   (void) len;
 
-  uint8_t next_report_id = report[0] + 1;
-
-  // Continue sending reports if necessary
-  if (next_report_id < REPORT_ID_COUNT)
+  // Every personality declares a single input report, sent from hid_task(), so nothing is chained
+  // here: a following report ID would belong to another personality's descriptor.
+  // Queue-to-read delay of the input report (seen from tud_task(), so it includes up to one loop pass).
+  // The Switch report has no ID: its first byte is data, and it is the only report.
+  if (personality() == PERSONALITY_SWITCH || report[0] == input_report_id())
   {
-    send_hid_report(next_report_id, board_button_read());
+    input_poll_delay_sample(time_us_32() - report_queued_us);
   }
 }
 
 // Handle GET_REPORT requests from the host (USB communication request)
+// Only the vendor feature reports are answered here; the gamepad state is sent on the interrupt endpoint.
 uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t* buffer, uint16_t reqlen)
 {
-  // This is where the device would send a report to the host when requested (not implemented here)
-  return 0;
+  (void) instance;
+
+  if (report_type != HID_REPORT_TYPE_FEATURE) return 0;
+
+  switch (report_id)
+  {
+    case REPORT_ID_TELEMETRY: return telemetry_get_report(buffer, reqlen);
+    case REPORT_ID_FW_UPDATE: return fw_update_get_report(buffer, reqlen);
+    case REPORT_ID_CALIBRATION: return calibration_get_report(buffer, reqlen);
+    case REPORT_ID_BUTTON_STATS: return button_stats_get_report(buffer, reqlen);
+    default: return 0;
+  }
 }
 
 // Handle SET_REPORT requests from the host (USB communication request)
 void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize)
 {
+  (void) instance;
+
+  if (report_type != HID_REPORT_TYPE_FEATURE) return;
+
+  switch (report_id)
+  {
+    case REPORT_ID_TELEMETRY: telemetry_set_report(buffer, bufsize); break;
+    case REPORT_ID_FW_UPDATE: fw_update_set_report(buffer, bufsize); break;
+    case REPORT_ID_CALIBRATION: calibration_set_report(buffer, bufsize); break;
+    case REPORT_ID_BUTTON_STATS: button_stats_set_report(buffer, bufsize); break;
+    default: break;
+  }
 }
 
 //--------------------------------------------------------------------+
@@ -294,15 +518,14 @@ void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_
  */
 void led_blinking_task(void)
 {
-  static uint32_t start_ms = 0;  // Keep track of the last time the LED was toggled
   static bool led_state = false;  // The current state of the LED (on or off)
 
   // If blinking is disabled (no interval set), return early
   if (!blink_interval_ms) return;
 
   // Check if enough time has passed to toggle the LED
-  if ( board_millis() - start_ms < blink_interval_ms ) return;
-  start_ms += blink_interval_ms;
+  periodic_set_period(&led_period, blink_interval_ms * 1000);
+  if ( !periodic_due(&led_period) ) return;
 
   // Control the external LED connected to GPIO 18
   gpio_put(LED_GPIO, led_state);  // Turn the LED on or off
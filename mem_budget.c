@@ -0,0 +1,133 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "mem_budget.h"
+
+#define STACK_PAINT_WORD   0xDEADBEEFu  // Pattern written into unused stack
+#define STACK_PROBE_PERIOD 256          // Sample one call in N per slot
+#define STACK_PROBE_GUARD  64           // Bytes left unpainted below SP for the painter's own frame
+
+// Core 0 stack bounds, provided by the SDK linker script (memmap_default.ld)
+extern uint32_t __StackBottom;
+extern uint32_t __StackTop;
+
+typedef struct
+{
+  uint32_t sp_at_begin;  // SP when the armed probe started
+  uint16_t high_water;   // Deepest stack use seen below sp_at_begin (bytes)
+  uint16_t countdown;    // Calls left until the next sampled call
+} stack_probe;
+
+static stack_probe probes[STACK_SLOT_COUNT];
+static volatile int8_t armed_slot = -1;  // Slot currently being measured, -1 when idle
+static uint16_t total_high_water = 0;     // Deepest use of the whole stack (bytes)
+
+static inline uint32_t current_sp(void)
+{
+  uint32_t sp;
+  __asm volatile ("mov %0, sp" : "=r" (sp));
+  return sp;
+}
+
+static void paint(uint32_t *from, uint32_t *to)
+{
+  while (from < to) *from++ = STACK_PAINT_WORD;
+}
+
+// Returns the lowest word in [from, to) that no longer holds the paint pattern
+static uint32_t *lowest_used(uint32_t *from, uint32_t *to)
+{
+  while (from < to && *from == STACK_PAINT_WORD) from++;
+  return from;
+}
+
+static void update_total_high_water(void)
+{
+  uint32_t used = (uint32_t) &__StackTop - (uint32_t) lowest_used(&__StackBottom, &__StackTop);
+  if (used > total_high_water) total_high_water = (uint16_t) used;
+}
+
+// Paint everything below the current frame. Must run early in main, before any deep call chains.
+void stack_paint_init(void)
+{
+  paint(&__StackBottom, (uint32_t *) (current_sp() - STACK_PROBE_GUARD));
+
+  for (int i = 0; i < STACK_SLOT_COUNT; i++)
+  {
+    probes[i].countdown = 1 + i;  // Stagger slots so their sampled calls do not line up
+  }
+}
+
+// Arm the probe for `slot` if this call is sampled and no other probe is armed
+void stack_probe_begin(stack_slot slot)
+{
+  stack_probe *p = &probes[slot];
+
+  if (armed_slot >= 0) return;
+  if (--p->countdown) return;
+  p->countdown = STACK_PROBE_PERIOD;
+
+  // Claim the probe before repainting so an interrupt probe cannot repaint underneath us
+  armed_slot = slot;
+  update_total_high_water();
+
+  p->sp_at_begin = current_sp();
+  paint(&__StackBottom, (uint32_t *) (p->sp_at_begin - STACK_PROBE_GUARD));
+}
+
+void stack_probe_end(stack_slot slot)
+{
+  if (armed_slot != slot) return;
+
+  stack_probe *p = &probes[slot];
+  uint32_t used = p->sp_at_begin - (uint32_t) lowest_used(&__StackBottom, (uint32_t *) p->sp_at_begin);
+  if (used > p->high_water) p->high_water = (uint16_t) used;
+
+  armed_slot = -1;
+}
+
+//----------------------- Telemetry -----------------------//
+// Page layout (little-endian):
+//   u16 stack_size, u16 total_high_water, u8 slot_count, u16 slot_high_water[slot_count]
+uint16_t mem_budget_telemetry(uint8_t *buf, uint16_t len)
+{
+  uint16_t const need = 5 + 2 * STACK_SLOT_COUNT;
+  if (len < need) return 0;
+
+  update_total_high_water();
+
+  uint16_t const stack_size = (uint16_t) ((uint32_t) &__StackTop - (uint32_t) &__StackBottom);
+  memcpy(&buf[0], &stack_size, 2);
+  memcpy(&buf[2], &total_high_water, 2);
+  buf[4] = STACK_SLOT_COUNT;
+
+  for (int i = 0; i < STACK_SLOT_COUNT; i++)
+  {
+    memcpy(&buf[5 + 2 * i], &probes[i].high_water, 2);
+  }
+  return need;
+}
@@ -0,0 +1,52 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MEM_BUDGET_H_
+#define MEM_BUDGET_H_
+
+#include <stdint.h>
+
+//----------------------- Stack Budget -----------------------//
+// Runtime stack high-water measurement by stack painting. The core 0 stack is filled with a known
+// pattern at boot; the deepest overwritten word tells how much stack was ever used.
+//
+// Individual tasks and interrupt handlers are measured with a begin/end probe pair. A probe only
+// samples one call in STACK_PROBE_PERIOD so the repaint cost stays out of the hot path, and only one
+// probe is armed at a time. Interrupts that fire inside an armed task probe are charged to that task.
+typedef enum
+{
+  STACK_SLOT_TUD_TASK = 0,  // tud_task() - TinyUSB device stack
+  STACK_SLOT_INPUT_TASK,    // input_task() - sampler start-up and housekeeping
+  STACK_SLOT_LED_TASK,      // led_blinking_task()
+  STACK_SLOT_HID_TASK,      // hid_task() - report generation
+  STACK_SLOT_COUNT
+} stack_slot;
+
+void stack_paint_init(void);
+void stack_probe_begin(stack_slot slot);
+void stack_probe_end(stack_slot slot);
+uint16_t mem_budget_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* MEM_BUDGET_H_ */
@@ -0,0 +1,212 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "midi.h"
+#include "cpu_load.h"
+
+// USB-MIDI code index numbers (first packet byte, low nibble)
+#define MIDI_CIN_NOTE_OFF       0x8
+#define MIDI_CIN_NOTE_ON        0x9
+#define MIDI_CIN_CONTROL_CHANGE 0xB
+
+#define MIDI_VELOCITY  100  // Buttons are not velocity sensitive
+
+typedef struct
+{
+  uint8_t button;   // Entry of _button_config (pico_hid.c), physical or virtual
+  uint8_t channel;  // 0-15, shown as 1-16 by most software
+  uint8_t note;
+} note_map;
+
+// Note configuration, a drum pad on channel 10 with General MIDI percussion notes
+static const note_map _midi_note_config[] = {
+    {0, 9, 36},  // South: bass drum
+    {1, 9, 38},  // East: snare
+    {2, 9, 42},  // North: closed hi-hat
+    {3, 9, 46},  // West: open hi-hat
+    {4, 9, 49},  // Mode: crash
+    {5, 9, 45},  // Select: low tom
+    {6, 9, 48},  // Start: high tom
+};
+
+typedef enum
+{
+  CC_SRC_STICK,  // Left stick axis (input_snapshot_t.axis)
+  CC_SRC_MUX,    // Analog mux channel (input_snapshot_t.mux)
+} cc_source_kind;
+
+typedef struct
+{
+  cc_source_kind source;
+  uint8_t index;       // Axis or mux channel
+  uint8_t channel;
+  uint8_t controller;  // Control change number
+  bool invert;
+} cc_map;
+
+// Control change configuration; only wired mux channels belong here, an open input sends noise
+static const cc_map _midi_cc_config[] = {
+    {CC_SRC_STICK, 0, 0, 16, false},  // Left stick X: general purpose 1
+    {CC_SRC_STICK, 1, 0, 17, true},   // Left stick Y: general purpose 2, up = 127
+    // {CC_SRC_MUX, 0, 0, 7, false},  // Fader on mux channel 0: channel volume
+};
+
+#define CC_UNSENT 0xFF
+
+typedef struct
+{
+  uint8_t value;    // Newest 7-bit value after hysteresis
+  uint8_t sent;     // Value the host last got, CC_UNSENT after mount
+  uint32_t sent_us;
+} cc_state;
+
+static cc_state controllers[count_of(_midi_cc_config)];
+static uint32_t sent_pressed;  // Buttons whose note on the host got, bit per _midi_note_config entry
+
+// Statistics for the telemetry page
+static uint32_t notes_sent;
+static uint32_t cc_sent;
+static uint32_t cc_deferred;   // Passes a changed controller waited for its interval
+static uint32_t queue_full;    // Events retried because the endpoint FIFO was full
+static uint16_t latency_last_us;  // First sample of the edge to note queued, debounce included
+static uint16_t latency_max_us;
+
+//----------------------- Events -----------------------//
+static bool write_event(uint8_t cin, uint8_t channel, uint8_t data1, uint8_t data2)
+{
+  uint8_t const packet[4] = {
+    (uint8_t) (MIDI_CABLE << 4 | cin),
+    (uint8_t) (cin << 4 | channel),
+    data1,
+    data2,
+  };
+  if (tud_midi_packet_write(packet)) return true;
+  queue_full++;
+  return false;
+}
+
+// A note only counts as sent once it is queued, so a full FIFO retries it on the next pass and
+// every note on keeps its note off
+static void send_notes(const input_snapshot_t *input, uint32_t now)
+{
+  for (unsigned i = 0; i < count_of(_midi_note_config); i++)
+  {
+    const note_map *n = &_midi_note_config[i];
+    uint32_t const bit = 1u << i;
+    bool const down = input->pressed & (1u << n->button);
+    if (down == ((sent_pressed & bit) != 0)) continue;
+
+    if (!write_event(down ? MIDI_CIN_NOTE_ON : MIDI_CIN_NOTE_OFF, n->channel, n->note, down ? MIDI_VELOCITY : 0)) return;
+    sent_pressed ^= bit;
+    notes_sent++;
+
+    uint32_t const latency = now - input->edge_us;
+    latency_last_us = latency > UINT16_MAX ? UINT16_MAX : (uint16_t) latency;
+    if (latency_last_us > latency_max_us) latency_max_us = latency_last_us;
+  }
+}
+
+//----------------------- Control Changes -----------------------//
+static uint16_t cc_source(const input_snapshot_t *input, const cc_map *c)
+{
+  uint16_t const v = c->source == CC_SRC_STICK ? input->axis[c->index] : input->mux[c->index];
+  return c->invert ? (uint16_t) (4095 - v) : v;
+}
+
+// The 7-bit value only follows the input once it is MIDI_CC_HYSTERESIS codes outside the current step
+static void cc_track(cc_state *s, uint16_t raw)
+{
+  int32_t const low = (int32_t) s->value * 32 - MIDI_CC_HYSTERESIS;
+  int32_t const high = (int32_t) s->value * 32 + 31 + MIDI_CC_HYSTERESIS;
+  if (s->sent == CC_UNSENT || raw < low || raw > high) s->value = (uint8_t) (raw >> 5);
+}
+
+static void send_controllers(const input_snapshot_t *input, uint32_t now)
+{
+  for (unsigned i = 0; i < count_of(_midi_cc_config); i++)
+  {
+    const cc_map *c = &_midi_cc_config[i];
+    cc_state *s = &controllers[i];
+    cc_track(s, cc_source(input, c));
+    if (s->value == s->sent) continue;
+
+    if (s->sent != CC_UNSENT && now - s->sent_us < MIDI_CC_INTERVAL_US)
+    {
+      cc_deferred++;
+      continue;
+    }
+    if (!write_event(MIDI_CIN_CONTROL_CHANGE, c->channel, c->controller, s->value)) return;
+    s->sent = s->value;
+    s->sent_us = now;
+    cc_sent++;
+  }
+}
+
+//----------------------- Task -----------------------//
+// The host state is unknown after a (re-)mount: held buttons play their note again and every
+// controller sends its current value
+static void midi_reset(void)
+{
+  sent_pressed = 0;
+  for (unsigned i = 0; i < count_of(controllers); i++) controllers[i].sent = CC_UNSENT;
+}
+
+void midi_task(void)
+{
+  if (!tud_midi_mounted())
+  {
+    midi_reset();
+    return;
+  }
+
+  // Nothing is played from the host; drain what it sends so its OUT endpoint never stalls
+  uint8_t packet[4];
+  while (tud_midi_available()) tud_midi_packet_read(packet);
+
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input)
+  {
+    uint32_t const now = time_us_32();
+    send_notes(input, now);
+    send_controllers(input, now);
+  }
+  cpu_load_exit();
+}
+
+uint16_t midi_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 20) return 0;
+
+  memcpy(&buf[0], &notes_sent, 4);
+  memcpy(&buf[4], &cc_sent, 4);
+  memcpy(&buf[8], &cc_deferred, 4);
+  memcpy(&buf[12], &queue_full, 4);
+  memcpy(&buf[16], &latency_last_us, 2);
+  memcpy(&buf[18], &latency_max_us, 2);
+  return 20;
+}
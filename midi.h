@@ -0,0 +1,51 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MIDI_H_
+#define MIDI_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- MIDI Personality -----------------------//
+// Presents the panel as a USB MIDI controller (class compliant, no driver needed) next to a HID
+// interface that only carries the vendor feature reports, so the host tools keep working.
+//
+// Buttons play notes (_midi_note_config in midi.c). The task checks the snapshot on every main loop
+// pass instead of waiting for a report slot, so a debounced edge goes out as soon as it is captured;
+// the delay from the acquisition block where the edge was first sampled to queueing the note, which
+// includes the debounce window, is measured on the MIDI telemetry page. Analog controls send
+// control changes (_midi_cc_config) when their 7-bit value moves, at most once per
+// MIDI_CC_INTERVAL_US per controller; the newest value is sent once the interval is over, so the
+// final position is never lost. All events found in one pass are queued back to back and share the
+// USB packets of the next frame (16 events per 64-byte packet).
+#define MIDI_CABLE           0
+#define MIDI_CC_INTERVAL_US  5000  // 200 messages per second per controller
+#define MIDI_CC_HYSTERESIS   24    // 12-bit codes past the edge of the current 7-bit step (32 codes wide)
+
+void midi_task(void);
+uint16_t midi_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* MIDI_H_ */
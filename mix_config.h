@@ -0,0 +1,56 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MIX_CONFIG_H_
+#define MIX_CONFIG_H_
+
+//----------------------- Axis Mixing Matrix -----------------------//
+// Which inputs feed which report axes (see mixer.h). Values are centered ADC codes (-2048..2047),
+// coefficients Q15 (MIX_Q15(1.0) = 32768, so gains above 1 are allowed).
+//
+// MIX_MATRIX: one X(output, input, coefficient) per non-zero coefficient; outputs sum their entries.
+// MIX_OUTPUTS: one X(output, offset, min, max) per report axis: added after the sum, then clamped.
+//
+// Examples:
+//   stick mounted 90 degrees clockwise   X(MIX_OUT_X, MIX_IN_STICK_Y, MIX_Q15(-1.0))
+//                                        X(MIX_OUT_Y, MIX_IN_STICK_X, MIX_Q15(1.0))
+//   inverted Y                           X(MIX_OUT_Y, MIX_IN_STICK_Y, MIX_Q15(-1.0))
+//   tank steering from two levers        X(MIX_OUT_Y, MIX_IN_MUX(0), MIX_Q15(0.5)) X(MIX_OUT_Y, MIX_IN_MUX(1), MIX_Q15(0.5))
+//                                        X(MIX_OUT_X, MIX_IN_MUX(0), MIX_Q15(0.5)) X(MIX_OUT_X, MIX_IN_MUX(1), MIX_Q15(-0.5))
+//
+// Report axes without a MIX_MATRIX entry are not written and stay 0, as before the mixer existed.
+#define MIX_MATRIX(X) \
+  X(MIX_OUT_X, MIX_IN_STICK_X, MIX_Q15(1.0)) \
+  X(MIX_OUT_Y, MIX_IN_STICK_Y, MIX_Q15(1.0))
+
+#define MIX_OUTPUTS(X) \
+  X(MIX_OUT_X,  0, -2048, 2047) \
+  X(MIX_OUT_Y,  0, -2048, 2047) \
+  X(MIX_OUT_Z,  0, -2048, 2047) \
+  X(MIX_OUT_RZ, 0, -2048, 2047) \
+  X(MIX_OUT_RX, 0, -2048, 2047) \
+  X(MIX_OUT_RY, 0, -2048, 2047)
+
+#endif /* MIX_CONFIG_H_ */
@@ -0,0 +1,116 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MIXER_H_
+#define MIXER_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- Axis Mixer -----------------------//
+// Maps the input channels onto the report axes through a sparse matrix of Q15 coefficients, with a
+// per-axis offset and clamp (configured in mix_config.h). The configuration is expanded at compile
+// time into one multiply-add per matrix entry, with every coefficient, offset and clamp a constant:
+// a coefficient of 1.0 folds into a plain copy, a configured clamp the entries cannot reach
+// disappears, and inputs without an entry are never read. The identity configuration therefore
+// compiles to the old fixed ADC 0 -> x, ADC 1 -> y moves plus the final 12-bit saturation.
+//
+// Products are shifted down by 15 without rounding (towards minus infinity), less than one code.
+typedef enum
+{
+  MIX_IN_STICK_X = 0,
+  MIX_IN_STICK_Y,
+  MIX_IN_MUX_FIRST,
+  MIX_INPUT_COUNT = MIX_IN_MUX_FIRST + INPUT_MUX_COUNT,
+} mix_input;
+
+#define MIX_IN_MUX(n) (MIX_IN_MUX_FIRST + (n))
+
+// In report order: hid_gamepad_report_t x, y, z, rz, rx, ry
+typedef enum
+{
+  MIX_OUT_X = 0,
+  MIX_OUT_Y,
+  MIX_OUT_Z,
+  MIX_OUT_RZ,
+  MIX_OUT_RX,
+  MIX_OUT_RY,
+  MIX_OUTPUT_COUNT,
+} mix_output;
+
+#define MIX_Q15(x)  ((int32_t) ((x) * 32768))
+#define MIX_CENTER  2048
+
+#include "mix_config.h"
+
+// Report axes with at least one matrix entry
+#define MIX_USED_BIT(o, i, c) | (1u << (o))
+enum { MIX_OUTPUT_USED = 0 MIX_MATRIX(MIX_USED_BIT) };
+#undef MIX_USED_BIT
+
+// 12-bit input `i`, from the sticks or the mux channels; constant-folded per entry
+#define MIX_INPUT(i) ((i) < MIX_IN_MUX_FIRST ? stick[(i)] : mux[(i) < MIX_IN_MUX_FIRST ? 0 : (i) - MIX_IN_MUX_FIRST])
+
+// Mix 12-bit sticks and mux channels into 12-bit report axes (centered on MIX_CENTER); axes not in
+// MIX_OUTPUT_USED are left untouched
+static inline void mixer_run(const uint16_t *stick, const uint16_t *mux, uint16_t *out)
+{
+  int32_t acc[MIX_OUTPUT_COUNT];
+
+#define MIX_OFFSET(o, offset, lo, hi) acc[(o)] = (offset);
+  MIX_OUTPUTS(MIX_OFFSET)
+#undef MIX_OFFSET
+
+#define MIX_ENTRY(o, i, c) acc[(o)] += ((c) * ((int32_t) MIX_INPUT(i) - MIX_CENTER)) >> 15;
+  MIX_MATRIX(MIX_ENTRY)
+#undef MIX_ENTRY
+
+  // Clamp to the configured range; a side is only checked if the entries and the offset can actually
+  // reach past it. Inputs span -2048..2047, so a positive coefficient reaches up with the input at
+  // 2047 and down at -2048, and a negative one the other way round. The result is then always
+  // saturated to 12 bits before it is written.
+#define MIX_REACH_UP(o2, i, c)   + ((o2) == mix_o ? ((int64_t) (c) * ((c) < 0 ? -MIX_CENTER : MIX_CENTER - 1)) >> 15 : 0)
+#define MIX_REACH_DOWN(o2, i, c) + ((o2) == mix_o ? ((int64_t) (c) * ((c) < 0 ? MIX_CENTER - 1 : -MIX_CENTER)) >> 15 : 0)
+#define MIX_CLAMP(o, offset, lo, hi) \
+  if (MIX_OUTPUT_USED & (1u << (o))) \
+  { \
+    int const mix_o = (o); \
+    int64_t const reach_up = (offset) MIX_MATRIX(MIX_REACH_UP); \
+    int64_t const reach_down = (offset) MIX_MATRIX(MIX_REACH_DOWN); \
+    if (reach_down < (lo) && acc[(o)] < (lo)) acc[(o)] = (lo); \
+    if (reach_up > (hi) && acc[(o)] > (hi)) acc[(o)] = (hi); \
+    if (acc[(o)] < -MIX_CENTER) acc[(o)] = -MIX_CENTER; \
+    if (acc[(o)] > MIX_CENTER - 1) acc[(o)] = MIX_CENTER - 1; \
+    out[(o)] = (uint16_t) (acc[(o)] + MIX_CENTER); \
+  }
+  MIX_OUTPUTS(MIX_CLAMP)
+#undef MIX_CLAMP
+#undef MIX_REACH_DOWN
+#undef MIX_REACH_UP
+}
+
+#undef MIX_INPUT
+
+#endif /* MIXER_H_ */
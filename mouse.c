@@ -0,0 +1,176 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "mouse.h"
+#include "quadrature.h"
+#include "cpu_load.h"
+
+#define MOUSE_MAX_DT_US  20000  // Longest gap integrated at once, after a stall
+#define PX_Q16_MAX       ((int32_t) INT16_MAX << 16)
+
+typedef struct
+{
+  uint8_t button;  // Entry of _button_config (pico_hid.c)
+  uint8_t mask;    // MOUSE_BUTTON_*
+} mouse_button_map;
+
+static const mouse_button_map _mouse_button_config[] = {
+    {0, MOUSE_BUTTON_LEFT},      // South
+    {1, MOUSE_BUTTON_RIGHT},     // East
+    {2, MOUSE_BUTTON_MIDDLE},    // North
+    {3, MOUSE_BUTTON_BACKWARD},  // West
+    {4, MOUSE_BUTTON_FORWARD},   // Mode
+};
+
+static int32_t acc_q16[2];       // Pixels not reported yet, X and Y
+static int encoder[2] = { -1, -1 };
+static int32_t last_count[2];
+static uint32_t last_us;
+
+// Saturates instead of wrapping while reports cannot go out
+static void accumulate(int axis, int64_t delta_q16)
+{
+  int64_t const acc = acc_q16[axis] + delta_q16;
+  acc_q16[axis] = (int32_t) (acc > PX_Q16_MAX ? PX_Q16_MAX : acc < -PX_Q16_MAX ? -PX_Q16_MAX : acc);
+}
+
+//----------------------- Stick -----------------------//
+// Speed over the deflection as 17 points, 0.25 x + 0.75 x^3 (Q16 of the full speed)
+#define STICK_CURVE_POINTS 17
+static const uint16_t stick_curve[STICK_CURVE_POINTS] =
+{
+  0, 1036, 2144, 3396, 4864, 6620, 8736, 11284, 14336,
+  17964, 22240, 27236, 33024, 39676, 47264, 55860, 65535
+};
+
+#define BOOST_ONE_Q16  65536
+#define BOOST_MAX_Q16  ((int32_t) MOUSE_STICK_BOOST_Q8 << 8)
+
+static int32_t boost_q16 = BOOST_ONE_Q16;
+
+static uint32_t stick_speed(int32_t deflection)
+{
+  // Full left is -2048 but full right only +2047; clamp so both ends stay on the last segment
+  uint32_t const magnitude = (uint32_t) abs(deflection);
+  uint32_t const t = (magnitude > 2047 ? 2047 : magnitude) << 5;  // 0..65504
+  uint32_t const seg = t >> 12;
+  uint32_t const frac = t & 0xFFF;
+  return stick_curve[seg] + ((((uint32_t) stick_curve[seg + 1] - stick_curve[seg]) * frac) >> 12);
+}
+
+static void stick_motion(const input_snapshot_t *input, uint32_t dt_us)
+{
+  int32_t const d[2] = { (int32_t) input->axis[0] - 2048, (int32_t) input->axis[1] - 2048 };  // Left stick
+
+  // Boost builds while the stick is held out on either axis, and drops as soon as it comes back
+  if (abs(d[0]) >= MOUSE_STICK_BOOST_FROM || abs(d[1]) >= MOUSE_STICK_BOOST_FROM)
+  {
+    boost_q16 += (int32_t) ((int64_t) (BOOST_MAX_Q16 - BOOST_ONE_Q16) * dt_us / (MOUSE_STICK_BOOST_MS * 1000));
+    if (boost_q16 > BOOST_MAX_Q16) boost_q16 = BOOST_MAX_Q16;
+  }
+  else
+  {
+    boost_q16 = BOOST_ONE_Q16;
+  }
+
+  for (int a = 0; a < 2; a++)
+  {
+    // Q16 fraction of the full speed x px/s x boost x s, in Q16 pixels
+    int64_t const step = (int64_t) stick_speed(d[a]) * MOUSE_STICK_MAX_PX_S * boost_q16 * dt_us / (1000000LL * BOOST_ONE_Q16);
+    accumulate(a, d[a] < 0 ? -step : step);
+  }
+}
+
+//----------------------- Trackball -----------------------//
+// One gain for both axes, from the combined speed, so the direction of motion is kept
+static int32_t ballistics_gain_q8(int32_t counts, uint32_t dt_us)
+{
+  int32_t const per_ms = (int32_t) ((int64_t) counts * 1000 / (dt_us ? dt_us : 1));
+  if (per_ms <= MOUSE_BALLISTICS_SLOW) return 256;
+  if (per_ms >= MOUSE_BALLISTICS_FAST) return MOUSE_BALLISTICS_GAIN_Q8;
+  return 256 + (MOUSE_BALLISTICS_GAIN_Q8 - 256) * (per_ms - MOUSE_BALLISTICS_SLOW) / (MOUSE_BALLISTICS_FAST - MOUSE_BALLISTICS_SLOW);
+}
+
+static void trackball_motion(uint32_t dt_us)
+{
+  int32_t c[2];
+  for (int a = 0; a < 2; a++)
+  {
+    int32_t const count = quadrature_count(encoder[a]);
+    c[a] = count - last_count[a];  // Correct across the 32-bit wrap
+    last_count[a] = count;
+  }
+
+  int32_t const gain = ballistics_gain_q8(abs(c[0]) + abs(c[1]), dt_us);
+  for (int a = 0; a < 2; a++) accumulate(a, (int64_t) c[a] * gain * 256);  // Q8 gain to Q16 pixels
+}
+
+//----------------------- Report -----------------------//
+void mouse_init(void)
+{
+  encoder[0] = quadrature_start(MOUSE_TRACKBALL_X_PIN_A);
+  encoder[1] = quadrature_start(MOUSE_TRACKBALL_Y_PIN_A);
+  last_count[0] = quadrature_count(encoder[0]);
+  last_count[1] = quadrature_count(encoder[1]);
+  last_us = time_us_32();
+}
+
+// Whole pixels of the accumulator, towards zero so the remainder keeps its sign
+static int16_t whole_pixels(int32_t q16)
+{
+  return (int16_t) (q16 / 65536);
+}
+
+void mouse_update_report(hid_mouse16_report_t *report)
+{
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input)
+  {
+    uint32_t const now = time_us_32();
+    uint32_t dt_us = now - last_us;
+    if (dt_us > MOUSE_MAX_DT_US) dt_us = MOUSE_MAX_DT_US;
+    last_us = now;
+
+    stick_motion(input, dt_us);
+    if (encoder[0] >= 0) trackball_motion(dt_us);
+
+    for (unsigned i = 0; i < count_of(_mouse_button_config); i++)
+    {
+      if (input->pressed & (1u << _mouse_button_config[i].button)) report->buttons |= _mouse_button_config[i].mask;
+    }
+    report->x = whole_pixels(acc_q16[0]);
+    report->y = whole_pixels(acc_q16[1]);
+  }
+  cpu_load_exit();
+}
+
+void mouse_report_sent(const hid_mouse16_report_t *report)
+{
+  acc_q16[0] -= (int32_t) report->x * 65536;
+  acc_q16[1] -= (int32_t) report->y * 65536;
+}
@@ -0,0 +1,64 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MOUSE_H_
+#define MOUSE_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- Mouse Personality -----------------------//
+// A pointer for menus from the stick, and a true mouse from a quadrature trackball, at the report rate.
+// Both sources are active together and add up:
+//   - the stick sets a velocity: its deflection goes through a response curve (fine control near
+//     center) and speeds up to MOUSE_STICK_BOOST_Q8 while it is held near full deflection;
+//   - the trackball counts (quadrature.h) are scaled by a speed-dependent gain (pointer ballistics):
+//     1:1 when the ball is rolled slowly, up to MOUSE_BALLISTICS_GAIN_Q8 when it is spun.
+// Motion is accumulated in 16.16 fixed point and only whole pixels are reported; the fraction stays in
+// the accumulator, so slow motion is never rounded away. A delta is only taken out of the accumulator
+// once its report was queued (mouse_report_sent()).
+#define MOUSE_STICK_MAX_PX_S       1500   // Pointer speed at full deflection, before the boost
+#define MOUSE_STICK_BOOST_Q8       512    // Speed factor after holding full deflection (2.0)
+#define MOUSE_STICK_BOOST_MS       1000   // Time from 1.0 to the full boost
+#define MOUSE_STICK_BOOST_FROM     1843   // Deflection (of 2047) that builds the boost, 90 %
+#define MOUSE_BALLISTICS_SLOW      2      // Trackball counts per ms up to which the gain is 1.0
+#define MOUSE_BALLISTICS_FAST      32     // Counts per ms from which the gain is MOUSE_BALLISTICS_GAIN_Q8
+#define MOUSE_BALLISTICS_GAIN_Q8   640    // 2.5
+#define MOUSE_TRACKBALL_X_PIN_A    14     // Phase B on 15
+#define MOUSE_TRACKBALL_Y_PIN_A    2      // Phase B on 3
+
+// Input report: 5 buttons, 16-bit relative X and Y
+typedef struct TU_ATTR_PACKED
+{
+  uint8_t buttons;  // MOUSE_BUTTON_* bits
+  int16_t x;
+  int16_t y;
+} hid_mouse16_report_t;
+
+void mouse_init(void);
+void mouse_update_report(hid_mouse16_report_t *report);
+void mouse_report_sent(const hid_mouse16_report_t *report);
+
+#endif /* MOUSE_H_ */
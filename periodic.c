@@ -0,0 +1,127 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "periodic.h"
+
+// Registered tasks, in periodic_init() order, for telemetry
+static periodic_task *tasks[PERIODIC_MAX_TASKS];
+static uint8_t task_count;
+
+// The first run is due straight away
+void periodic_init(periodic_task *task, uint32_t period_us, periodic_policy policy)
+{
+  memset(task, 0, sizeof(*task));
+  task->period_us = period_us;
+  task->policy = policy;
+  task->next_us = time_us_64();
+
+  if (task_count < PERIODIC_MAX_TASKS) tasks[task_count++] = task;
+}
+
+// A new period applies from the next deadline on
+void periodic_set_period(periodic_task *task, uint32_t period_us)
+{
+  if (period_us == task->period_us) return;
+  task->next_us += (int64_t) period_us - task->period_us;
+  task->period_us = period_us;
+}
+
+static uint8_t late_bucket(uint32_t late_us)
+{
+  uint8_t bucket = 0;
+  for (late_us >>= 4; late_us && bucket < PERIODIC_BUCKETS - 1; late_us >>= 2) bucket++;
+  return bucket;
+}
+
+static void record(periodic_task *task, uint32_t late_us)
+{
+  uint16_t *slot = &task->late[late_bucket(late_us)];
+  if (*slot == UINT16_MAX)
+  {
+    for (int i = 0; i < PERIODIC_BUCKETS; i++) task->late[i] >>= 1;
+  }
+  (*slot)++;
+
+  if (late_us > task->max_late_us) task->max_late_us = late_us;
+  task->runs++;
+}
+
+bool periodic_due(periodic_task *task)
+{
+  uint64_t const now = time_us_64();
+  if (now < task->next_us) return false;
+
+  uint64_t const late64 = now - task->next_us;
+  uint32_t const late_us = late64 > UINT32_MAX ? UINT32_MAX : (uint32_t) late64;
+  record(task, late_us);
+
+  // Whole periods that went by since the deadline (32-bit, so the hardware divider does it)
+  uint32_t const missed = task->period_us && late_us >= task->period_us ? late_us / task->period_us : 0;
+
+  switch (task->policy)
+  {
+    case PERIODIC_SKIP:
+      task->misses += missed;
+      task->next_us += (uint64_t) (missed + 1) * task->period_us;
+      break;
+
+    case PERIODIC_CATCH_UP:
+      // Missed deadlines still run, late, one per call: each run that starts after the next
+      // deadline has already passed is one miss
+      task->misses += missed != 0;
+      task->next_us += task->period_us;
+      break;
+
+    case PERIODIC_REPHASE:
+      task->misses += missed;
+      task->next_us = now + task->period_us;
+      break;
+  }
+  return true;
+}
+
+// Telemetry page: u8 task count, then per task { u32 runs, u32 misses, u32 max_late_us,
+// u16 late[PERIODIC_BUCKETS] } for as many tasks as fit
+uint16_t periodic_telemetry(uint8_t *buf, uint16_t len)
+{
+  uint16_t const per_task = 12 + 2 * PERIODIC_BUCKETS;
+  if (len < 1) return 0;
+
+  uint8_t n = 0;
+  uint8_t *p = &buf[1];
+  for (; n < task_count && (uint16_t) (p - buf) + per_task <= len; n++)
+  {
+    periodic_task const *t = tasks[n];
+    memcpy(p, &t->runs, 4);
+    memcpy(p + 4, &t->misses, 4);
+    memcpy(p + 8, &t->max_late_us, 4);
+    memcpy(p + 12, t->late, 2 * PERIODIC_BUCKETS);
+    p += per_task;
+  }
+  buf[0] = n;
+  return (uint16_t) (p - buf);
+}
@@ -0,0 +1,71 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PERIODIC_H_
+#define PERIODIC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Periodic Tasks -----------------------//
+// Deadline tracking for the superloop's periodic tasks on the 64-bit microsecond timer (no wrap).
+// A task asks periodic_due() on every loop pass and runs its body when it returns true. When the loop
+// has stalled past one or more deadlines, the task's policy decides what happens next:
+//
+//   PERIODIC_SKIP       drop the missed runs and stay on the original grid (reports: no duplicates)
+//   PERIODIC_CATCH_UP   run once per missed deadline, back to back, until caught up (counting)
+//   PERIODIC_REPHASE    start a new grid from now (blinking, timeouts)
+//
+// Every run records how late it started in a histogram with buckets < 16, 64, 256 us, 1, 4, 16, 64 ms
+// and beyond; every deadline that passed without a run counts as a miss. When a bucket fills up,
+// all buckets are halved, so the histogram keeps its shape over long sessions.
+#define PERIODIC_MAX_TASKS      4
+#define PERIODIC_BUCKETS        8
+
+typedef enum
+{
+  PERIODIC_SKIP = 0,
+  PERIODIC_CATCH_UP,
+  PERIODIC_REPHASE,
+} periodic_policy;
+
+typedef struct
+{
+  uint64_t next_us;       // Next deadline
+  uint32_t period_us;
+  periodic_policy policy;
+
+  uint32_t runs;
+  uint32_t misses;
+  uint32_t max_late_us;
+  uint16_t late[PERIODIC_BUCKETS];
+} periodic_task;
+
+void periodic_init(periodic_task *task, uint32_t period_us, periodic_policy policy);
+void periodic_set_period(periodic_task *task, uint32_t period_us);
+bool periodic_due(periodic_task *task);
+uint16_t periodic_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* PERIODIC_H_ */
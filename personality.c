@@ -0,0 +1,72 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "pico/stdlib.h"
+#include "personality.h"
+
+#define PERSONALITY_SETTLE_US 50  // Pull-ups charging the button wiring before the pins are read
+
+typedef struct
+{
+  uint8_t gpio_pin;    // Button held at power-up (pulled up, pressed = low)
+  personality_id id;
+} personality_select;
+
+// Boot buttons, first match wins; pins are the ones of _button_config (pico_hid.c)
+static const personality_select _personality_config[] = {
+    {8, PERSONALITY_WHEEL},     // East button
+    {5, PERSONALITY_KEYBOARD},  // North button
+    {6, PERSONALITY_MOUSE},     // West button
+    {21, PERSONALITY_SWITCH},   // Start button
+    {20, PERSONALITY_MIDI},     // Select button
+    {9, PERSONALITY_JVS},       // Mode button
+};
+
+static personality_id current = PERSONALITY_GAMEPAD;
+
+void personality_init(void)
+{
+  for (uint i = 0; i < count_of(_personality_config); i++)
+  {
+    gpio_init(_personality_config[i].gpio_pin);
+    gpio_set_dir(_personality_config[i].gpio_pin, GPIO_IN);
+    gpio_pull_up(_personality_config[i].gpio_pin);
+  }
+  busy_wait_us(PERSONALITY_SETTLE_US);
+
+  for (uint i = 0; i < count_of(_personality_config); i++)
+  {
+    if (!gpio_get(_personality_config[i].gpio_pin))
+    {
+      current = _personality_config[i].id;
+      break;
+    }
+  }
+}
+
+personality_id personality(void)
+{
+  return current;
+}
@@ -0,0 +1,52 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PERSONALITY_H_
+#define PERSONALITY_H_
+
+#include <stdint.h>
+
+//----------------------- Personality -----------------------//
+// What the controller presents itself as on USB. The personality is picked once at power-up, from the
+// button held while the controller is plugged in (see _personality_config in personality.c), and
+// decides the USB product ID, the report descriptor and which input report is built. Each personality
+// has its own product ID because hosts cache the descriptors per VID/PID.
+typedef enum
+{
+  PERSONALITY_GAMEPAD = 0,  // Gamepad report (pico_hid.c), nothing held
+  PERSONALITY_WHEEL,        // Steering wheel and pedals (wheel.c)
+  PERSONALITY_KEYBOARD,     // N-key-rollover keyboard (keyboard.c)
+  PERSONALITY_MOUSE,        // Mouse from the stick and a trackball (mouse.c)
+  PERSONALITY_SWITCH,       // Wired pad for the Nintendo Switch (switch_pad.c)
+  PERSONALITY_MIDI,         // USB MIDI notes and control changes (midi.c)
+  PERSONALITY_JVS,          // JVS arcade I/O board on RS-485 (jvs.c)
+  PERSONALITY_COUNT
+} personality_id;
+
+// Reads the boot buttons; call before tusb_init()
+void personality_init(void);
+personality_id personality(void);
+
+#endif /* PERSONALITY_H_ */
@@ -23,10 +23,22 @@
  *
  */
 
+#include <string.h>
 #include "pico/stdlib.h"  // Standard I/O for Pico SDK (to control GPIOs, etc.)
 #include "tusb.h"         // TinyUSB library for USB communication
 #include "pico_hid.h"     // Custom header for gamepad HID reports
 #include "hardware/adc.h" // Library to interact with the Analog-to-Digital Converter (ADC)
+#include "boot_profile.h" // Boot milestone timestamps
+#include "adc_correction.h" // ADC DNL/INL correction table
+#include "drift.h"          // Stick center tracking and deadzone
+#include "tempco.h"         // Temperature compensation of the stick centers
+#include "axis_health.h"    // Stick wear statistics
+#include "button_stats.h"   // Button actuation counters
+#include "sampler.h"        // Multi-rate sampling scheduler
+#include "acquire.h"        // DMA/PIO input acquisition
+#include "cpu_load.h"       // CPU time accounting
+#include "predictor.h"      // Stick position extrapolation
+#include "mixer.h"          // Input channels to report axes
 
 //----------------------- Components of Digital Systems -----------------------//
 // Enum for joystick directions
@@ -70,13 +82,18 @@ static joystick_adc_map_t joy_map[2]; // Define joy_map for 2 axes (X and Y)
 
 //----------------------- Components of Digital Systems (Digital Systems Architecture) -----------------------//
 
-// Struct for ADC source (joystick analog input)
-// Each joystick axis is connected to a specific ADC channel (X-axis or Y-axis). This struct defines
-// the source of the joystick input, specifying the ADC channel used.
+// Struct for ADC source (analog input used as a virtual button)
+// A virtual button reads one analog channel (a stick axis, a trigger on the mux, ...) and is pressed
+// while the value is past a threshold. Press and release thresholds differ, so a value sitting right
+// at the threshold does not chatter. With press above release the button is pressed by high values
+// (e.g. a trigger pulled in), with press below release by low values (e.g. a stick pushed left).
+// `action` comes first, as in button_source, so both kinds map to gamepad buttons the same way.
 typedef struct
 {
-  joy_direction direction;  // Joystick direction (X or Y)
-  uint8_t adc_channel;      // The ADC channel corresponding to this joystick axis
+  uint32_t action;          // Action associated with the virtual button (e.g., GAMEPAD_BUTTON_TL2)
+  uint8_t adc_channel;      // Entry of _analog_config the virtual button reads
+  uint16_t press;           // Linearised 12-bit value at which the button is pressed
+  uint16_t release;         // Linearised 12-bit value at which it is released again
 } adc_source;
 
 // Union for input sources (buttons or joystick ADC)
@@ -99,6 +116,48 @@ typedef struct
   input_source data;          // Data associated with the input (button GPIO pin or ADC channel)
 } button_data;
 
+//----------------------- Components of Digital Systems (Analog Inputs) -----------------------//
+// Analog channel configuration
+// One ADC conversion per entry and acquisition block, in this order (see acquire.h). The joystick and
+// the temperature sensor are wired straight to the ADC; the other analog controls (sliders, knobs,
+// pedals) go through a 4067 16-channel analog mux on ADC input 2. Each mux channel has its own settle
+// time, which depends on the source impedance of the control wired to it.
+#define MUX_SETTLE_NS 1000  // 10k potentiometer into the mux and ADC input capacitance
+
+enum
+{
+  ANALOG_STICK_X = 0,
+  ANALOG_STICK_Y,
+  ANALOG_TEMPERATURE,
+  ANALOG_MUX_FIRST,
+};
+
+const acquire_channel _analog_config[] = {
+    {0, 0, 0},                                    // Left joystick X-axis on GPIO 26
+    {1, 0, 0},                                    // Left joystick Y-axis on GPIO 27
+    {TEMPCO_ADC_INPUT, 0, 0},                     // On-chip temperature sensor
+    {ACQUIRE_MUX_ADC_INPUT, 0, MUX_SETTLE_NS},    // Mux channels 0-15 on GPIO 28
+    {ACQUIRE_MUX_ADC_INPUT, 1, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 2, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 3, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 4, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 5, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 6, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 7, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 8, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 9, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 10, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 11, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 12, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 13, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 14, MUX_SETTLE_NS},
+    {ACQUIRE_MUX_ADC_INPUT, 15, MUX_SETTLE_NS}};
+
+const int _analog_config_count = count_of(_analog_config);  // The total number of conversions per block
+
+_Static_assert(count_of(_analog_config) == ANALOG_MUX_FIRST + INPUT_MUX_COUNT, "one entry per mux channel");
+_Static_assert(count_of(_analog_config) <= ACQUIRE_ADC_MAX, "too many analog channels");
+
 //----------------------- Components of Digital Systems (Input Devices) -----------------------//
 // Button configuration
 // This array defines the mapping of the gamepad buttons to specific GPIO pins.
@@ -111,29 +170,164 @@ const button_data _button_config[] = {
     {SRC_BUTTON, {.button_src = {GAMEPAD_BUTTON_WEST, 6}}},    // West button on GPIO 6
     {SRC_BUTTON, {.button_src = {GAMEPAD_BUTTON_MODE, 9}}},    // Mode button on GPIO 9
     {SRC_BUTTON, {.button_src = {GAMEPAD_BUTTON_SELECT, 20}}}, // Select button on GPIO 20
-    {SRC_BUTTON, {.button_src = {GAMEPAD_BUTTON_START, 21}}}}; // Start button on GPIO 21
+    {SRC_BUTTON, {.button_src = {GAMEPAD_BUTTON_START, 21}}}, // Start button on GPIO 21
+    // Analog triggers on mux channels 0 and 1 also as digital L2/R2, for games that want buttons.
+    // Enable once the triggers are wired; an open mux input reads random values. Nine entries need a
+    // larger BUTTON_STATS_COUNT (button_stats.h).
+    // {SRC_ADC, {.adc_src = {GAMEPAD_BUTTON_TL2, ANALOG_MUX_FIRST + 0, 2600, 2200}}},
+    // {SRC_ADC, {.adc_src = {GAMEPAD_BUTTON_TR2, ANALOG_MUX_FIRST + 1, 2600, 2200}}},
+};
+
+const int _button_config_count = count_of(_button_config);  // The total number of buttons configured
+
+_Static_assert(count_of(_button_config) <= 32, "one bit per button in the pressed mask");
+_Static_assert(count_of(_button_config) <= BUTTON_STATS_COUNT, "raise BUTTON_STATS_COUNT (button_stats.h) for wear statistics on every button");
+
+// Layer configuration
+// Like layers on a QMK keyboard: while the `hold` button is held, the other buttons send the actions of
+// that layer instead of their own, which gives a few buttons many more functions. Entries are indexed
+// like _button_config; 0 means "same as layer 0" (the actions in _button_config). Layer 0 is always
+// active, and when several layer buttons are held the last layer in the table wins. A layer button
+// itself never sends an action.
+#define LAYER_NO_HOLD UINT8_MAX  // Layer 0 has no hold button
+
+typedef struct
+{
+  uint8_t hold;         // Entry of _button_config that activates the layer while held
+  uint32_t action[32];  // Action per entry of _button_config while the layer is active
+} layer_data;
+
+const layer_data _layer_config[] = {
+    {LAYER_NO_HOLD, {0}},  // Layer 0: the actions in _button_config
+    // Mode (entry 4) as a shift button: 6 more actions from the same panel.
+    // {4, {[0] = GAMEPAD_BUTTON_TL, [1] = GAMEPAD_BUTTON_TR, [2] = GAMEPAD_BUTTON_THUMBL,
+    //      [3] = GAMEPAD_BUTTON_THUMBR, [5] = GAMEPAD_BUTTON_TL2, [6] = GAMEPAD_BUTTON_TR2}},
+};
+
+_Static_assert(count_of(_layer_config) <= 8, "layer numbers are stored in a byte per button");
+
+//----------------------- Virtual Buttons -----------------------//
+// SRC_ADC entries, evaluated on every converted block. Each one is stored in "high side" form: a
+// low-side button compares the inverted value (4095 - v, an XOR on 12 bits) against inverted
+// thresholds, so the evaluation is the same compare-and-mask for every button, without branches:
+//   pressed = (v >= press) | (was_pressed & (v > release))
+// The result lands on the same bit as a physical button would (bit i = _button_config[i]), so
+// virtual and physical buttons go through the same mapping and statistics.
+typedef struct
+{
+  uint8_t channel;    // Entry of the analog block
+  uint8_t bit;        // Bit in the pressed mask
+  uint16_t flip;      // 0 for high side, 0xFFF for low side
+  int16_t press;      // Thresholds, high side form
+  int16_t release;
+} virtual_button;
+
+static virtual_button virtual_buttons[32];
+static uint8_t virtual_count;
+
+static void add_virtual_button(int index, const adc_source *src)
+{
+  bool const low_side = src->press < src->release;
+  uint16_t const flip = low_side ? 0xFFF : 0;
+  int16_t const press = (int16_t) (src->press ^ flip);
+  int16_t const release = (int16_t) (src->release ^ flip);  // The side is picked so that release <= press
+
+  virtual_buttons[virtual_count++] = (virtual_button) { src->adc_channel, (uint8_t) index, flip, press, release };
+}
+
+static uint32_t evaluate_virtual_buttons(const uint16_t *analog, uint32_t pressed)
+{
+  uint32_t next = 0;
+  for (uint8_t i = 0; i < virtual_count; i++)
+  {
+    const virtual_button *b = &virtual_buttons[i];
+    int32_t const v = analog[b->channel] ^ b->flip;
+    uint32_t const past_press = (uint32_t) (b->press - v - 1) >> 31;   // v >= press
+    uint32_t const past_release = (uint32_t) (b->release - v) >> 31;   // v > release
+    uint32_t const held = (pressed >> b->bit) & 1;
+    next |= (past_press | (held & past_release)) << b->bit;
+  }
+  return next;
+}
 
-const int _button_config_count = 6;  // The total number of buttons configured
+//----------------------- Layers -----------------------//
+// The action of every button on every layer is resolved once at setup, so the per-tick work is a mask
+// test per layer button and a table lookup per pressed button.
+//
+// A button keeps the layer that was active when it was pressed until it is released, whatever happens to
+// the layer buttons in between. Releasing the layer button while still holding a layered button keeps
+// sending the layered action until that button is released, and pressing it does not change buttons that
+// are already held: the host always sees the release of exactly the action it saw pressed, so nothing can
+// stay stuck on the host across a layer switch.
+static uint32_t layer_action[count_of(_layer_config)][count_of(_button_config)];
+static uint32_t layer_hold[count_of(_layer_config)];  // Pressed-mask bit of each layer's hold button
+static uint32_t layer_keys;                           // All hold buttons
+static uint8_t key_layer[count_of(_button_config)];   // Layer each pressed button was pressed on
+
+static void setup_layers(void)
+{
+  for (int l = 0; l < (int) count_of(_layer_config); l++)
+  {
+    uint8_t const hold = _layer_config[l].hold;
+    layer_hold[l] = hold < _button_config_count ? 1u << hold : 0;
+    layer_keys |= layer_hold[l];
+  }
+
+  for (int l = 0; l < (int) count_of(_layer_config); l++)
+  {
+    for (int i = 0; i < _button_config_count; i++)
+    {
+      // action comes first in both button_source and adc_source
+      uint32_t const action = _layer_config[l].action[i];
+      layer_action[l][i] = (layer_keys & (1u << i)) ? 0 : action ? action : _button_config[i].data.button_src.action;
+    }
+  }
+}
+
+// Highest layer whose hold button is pressed
+static uint8_t resolve_layer(uint32_t pressed)
+{
+  if (!(pressed & layer_keys)) return 0;  // The common case: no layer button held
+
+  uint8_t l = count_of(_layer_config) - 1;
+  while (l > 0 && !(pressed & layer_hold[l])) l--;
+  return l;
+}
 
 //----------------------- Components of Digital Systems -----------------------//
 // Setup GPIO for buttons
 // This function initializes the GPIO pins used by the buttons so that the system can detect button presses.
 // For each button, it initializes the corresponding GPIO pin as an input and enables the pull-up resistor.
+// Only the cheap GPIO setup happens here; the ADC is brought up lazily by input_task() so USB
+// enumeration can start as early as possible after reset.
 void setup_controller_buttons(void)
 {
   for (int i = 0; i < _button_config_count; i++)  // Loop through each button configuration
   {
+    if (_button_config[i].source == SRC_ADC)
+    {
+      add_virtual_button(i, &_button_config[i].data.adc_src);
+      continue;
+    }
+
     // Initialize GPIO pin for the button
     gpio_init(_button_config[i].data.button_src.gpio_pin);
     gpio_set_dir(_button_config[i].data.button_src.gpio_pin, GPIO_IN);  // Set pin as input
     gpio_pull_up(_button_config[i].data.button_src.gpio_pin);  // Enable pull-up resistor
   }
+  setup_layers();
+}
 
-  // Initialize ADC for joystick - Analog Input Devices
-  // The joystick is an analog device, so we configure the ADC channels for the X and Y axes.
+// Setup ADC for the joystick - Analog Input Devices
+// The joystick is an analog device, so we configure the ADC channels for the X and Y axes.
+static void setup_controller_analog(void)
+{
   adc_init();  // Initialize the ADC hardware
   adc_gpio_init(26);  // GPIO 26 connected to the joystick X-axis (ADC input)
   adc_gpio_init(27);  // GPIO 27 connected to the joystick Y-axis (ADC input)
+  adc_gpio_init(28);  // GPIO 28 connected to the analog mux output (ADC input)
+  adc_correction_init();  // Build the DNL/INL correction table (per-unit table from flash or errata model)
+  tempco_init();  // Enable the on-chip temperature sensor (ADC input 4) and load the stick temperature model
 }
 
 //----------------------- Data and Storage (Binary Representation) -----------------------//
@@ -148,44 +342,400 @@ bool is_empty(const hid_gamepad_report_t *report)
 }
 
 //----------------------- Input Devices -----------------------//
-// Update button values in HID report
-// This function reads the state of each button (via its GPIO pin) and updates the HID report to reflect
-// whether the button is pressed. It interacts directly with the hardware (GPIO) and converts this 
-// input into data that can be sent via USB to the host.
-void update_button(hid_gamepad_report_t *report, const button_source *data)
+// Update button values in the input snapshot
+// This function checks the state of each button (its GPIO pin in the debounced GPIO mask) and updates
+// the pressed mask to reflect whether the button is pressed. The mask has one bit per physical button
+// (bit i = _button_config[i]); wear statistics work on physical buttons, and button_actions() turns
+// the mask into gamepad buttons.
+void update_button(uint32_t *pressed, int index, const button_source *data, uint32_t gpio_low)
 {
-  if (!gpio_get(data->gpio_pin))  // If button is pressed (GPIO pin is pulled low)
+  if (gpio_low & (1u << data->gpio_pin))  // If button is pressed (GPIO pin is pulled low)
   {
-    report->buttons |= data->action;  // Set the corresponding button action in the report
+    *pressed |= 1u << index;  // Set the corresponding physical button in the mask
   }
 }
 
-//----------------------- Networks and the Internet (USB Communication) -----------------------//
-// Update the HID report for the controller
-// This function collects input from all buttons and the joystick and updates the gamepad HID report.
-// It reads the button states (digital input) and the joystick positions (analog input via ADC) and
-// prepares a structured HID report to be sent to the host via USB.
-void update_hid_report_controller(hid_gamepad_report_t *report)
+// Gamepad button mask for a mask of pressed physical buttons. Buttons in `down` were just pressed and
+// take the current layer; the others keep the layer they were pressed on (see Layers).
+static uint32_t button_actions(uint32_t pressed, uint32_t down)
+{
+  uint8_t const layer = resolve_layer(pressed);
+  uint32_t buttons = 0;
+  for (int i = 0; i < _button_config_count; i++)
+  {
+    if (!(pressed & (1u << i))) continue;
+    if (down & (1u << i)) key_layer[i] = layer;
+    buttons |= layer_action[key_layer[i]][i];
+  }
+  return buttons;
+}
+
+//----------------------- Input Sampling -----------------------//
+// Latest converted state of every input. Acquisition runs from boot, independent of the USB state, so a
+// valid snapshot already exists when the host mounts the device and asks for the first report.
+// All conditioning state (debounce, and later filters) lives here too and is never reset on a bus
+// reset, so reports after a re-mount are as clean as the ones before it.
+static input_snapshot_t snapshot;
+static bool acquiring = false;
+
+//----------------------- Sample Rates -----------------------//
+// Sticks and buttons are sampled by DMA and PIO at ACQUIRE_BLOCK_HZ (acquire.h) and only converted
+// when a report is built. The slow sources run from the sampling scheduler (sampler.h).
+#define SAMPLE_RATE_HOUSEKEEPING_HZ  (1000000 / DRIFT_TICK_US)
+#define SAMPLE_RATE_TEMPERATURE_HZ   10
+
+//----------------------- Button Debounce -----------------------//
+// A GPIO changes state once it has read the same new value in all of the newest BUTTON_DEBOUNCE_BLOCKS
+// acquisition blocks, i.e. 1 ms at ACQUIRE_BLOCK_HZ. The check runs on all 32 GPIOs at once straight
+// from the block ring, so it costs the same however many buttons there are.
+#define BUTTON_DEBOUNCE_BLOCKS 8
+
+static uint32_t gpio_low;     // Debounced GPIO mask, bit set = pin reads low
+static uint32_t pin_pressed;  // Buttons on GPIO pins, bit i = _button_config[i]
+static uint32_t pressed;      // All buttons, pins and virtual
+static uint32_t pin_edge_us;  // Capture time of the block where the newest button pin change first showed
+static bool pin_edge_new;     // pin_edge_us not yet taken by convert_buttons()
+
+// Returns the GPIOs that changed state
+static uint32_t debounce_gpio(void)
+{
+  uint32_t all_high, all_low;
+  acquire_gpio_window(BUTTON_DEBOUNCE_BLOCKS, &all_high, &all_low);
+
+  uint32_t const before = gpio_low;
+  gpio_low = (gpio_low | all_low) & ~all_high;
+  return gpio_low ^ before;
+}
+
+//----------------------- Latency Prediction -----------------------//
+// Each axis can be extrapolated to the time the host is expected to read the report: the report build
+// time plus the measured delay from queuing a report to its completion (an average of the host's poll
+// phase). Off by default; switched on per axis with the calibration report (PREDICTOR op).
+#define POLL_DELAY_SHIFT 3  // Poll delay average over about 8 reports
+#define BLOCK_AGE_US     (1000000 / ACQUIRE_BLOCK_HZ / 2)  // Average age of the newest block when converted
+
+static predictor axis_predictor[INPUT_AXIS_COUNT];
+static predictor_config predictor_cfg[INPUT_AXIS_COUNT] =
+{
+  [ADC_LEFT_JOY_X] = { .alpha_q8 = 128, .beta_q8 = 32, .horizon_us = 0, .overshoot = 64 },
+  [ADC_LEFT_JOY_Y] = { .alpha_q8 = 128, .beta_q8 = 32, .horizon_us = 0, .overshoot = 64 },
+};
+static uint32_t poll_delay_us;
+
+static void predict_update(uint32_t now)
+{
+  for (int i = 0; i < INPUT_AXIS_COUNT; i++)
+  {
+    predictor_update(&axis_predictor[i], &predictor_cfg[i], snapshot.axis[i], now - BLOCK_AGE_US);
+  }
+}
+
+void input_set_predictor(uint8_t axis, const predictor_config *config)
 {
-  // Update the button states
+  if (axis >= INPUT_AXIS_COUNT) return;
+  predictor_cfg[axis] = *config;
+  predictor_reset(&axis_predictor[axis]);
+}
+
+// Time from queuing a gamepad report to the host reading it
+void input_poll_delay_sample(uint32_t delay_us)
+{
+  int32_t const error = (int32_t) delay_us - (int32_t) poll_delay_us;
+  poll_delay_us += error >> POLL_DELAY_SHIFT;
+}
+
+//----------------------- Block Conversion -----------------------//
+// Turns the newest acquisition block into the snapshot. Runs in the main loop when a report is built
+// and on every housekeeping tick, so the snapshot also moves while no reports are sent.
+
+static uint16_t analog[ACQUIRE_ADC_MAX];  // Newest block, linearised, one value per _analog_config entry
+
+// Pin mask only changes on a debounced GPIO change
+static void convert_pins(void)
+{
+  uint32_t const changed = debounce_gpio();
+  if (!changed) return;
+
+  uint32_t next = 0;
+  uint32_t button_pins = 0;
   for (int i = 0; i < _button_config_count; i++)
   {
-    update_button(report, &_button_config[i].data.button_src);  // Update each button in the HID report
+    if (_button_config[i].source != SRC_BUTTON) continue;
+    update_button(&next, i, &_button_config[i].data.button_src, gpio_low);  // Update each button in the mask
+    button_pins |= 1u << _button_config[i].data.button_src.gpio_pin;
+  }
+
+  // The edge itself was captured before the debounce window filled; other pins (encoders) do not count
+  if (next != pin_pressed)
+  {
+    pin_edge_us = acquire_gpio_edge_us(changed & button_pins);
+    pin_edge_new = true;
+  }
+  pin_pressed = next;
+}
+
+// Mapping and wear statistics only run when a button changed
+static void convert_buttons(uint32_t now)
+{
+  uint32_t const next = pin_pressed | evaluate_virtual_buttons(analog, pressed);
+  if (next != pressed)
+  {
+    snapshot.buttons = button_actions(next, next & ~pressed);
+    snapshot.pressed = next;
+    snapshot.edge_us = pin_edge_new ? pin_edge_us : acquire_block_us();  // Virtual buttons: newest ADC block
+    pin_edge_new = false;
+    button_stats_edges(next, next ^ pressed, now);
+    pressed = next;
   }
+}
+
+static void convert_sticks(uint32_t now)
+{
+  static uint8_t last_block = UINT8_MAX;
+  uint16_t adc[ACQUIRE_ADC_MAX];
+
+  uint8_t const block = acquire_adc_latest(adc);
+  if (block == last_block) return;  // Nothing new since the last conversion
+  last_block = block;
+
+  for (int i = 0; i < _analog_config_count; i++)
+  {
+    analog[i] = adc_correct(adc[i]);
+  }
+
+  //----------------------- Input Devices (Joystick) -----------------------//
+  // Joystick ADC values
+  // The joystick is an analog input device. The ADC (Analog-to-Digital Converter) measures its
+  // position; X is ADC input 0 (GPIO 26) and Y is ADC input 1 (GPIO 27), 12-bit values between 0 and 4095.
+  joy_map[0].value = analog[ANALOG_STICK_X]; // X-axis value, linearised
+  joy_map[1].value = analog[ANALOG_STICK_Y]; // Y-axis value, linearised
+
+  snapshot.axis_raw[ADC_LEFT_JOY_X] = joy_map[0].value;
+  snapshot.axis_raw[ADC_LEFT_JOY_Y] = joy_map[1].value;
+
+  // Stick centers follow slow drift; the first sample after boot seeds them
+  if (!snapshot.valid) drift_init(snapshot.axis_raw);
+
+  snapshot.axis[ADC_LEFT_JOY_X] = drift_condition(ADC_LEFT_JOY_X, joy_map[0].value);
+  snapshot.axis[ADC_LEFT_JOY_Y] = drift_condition(ADC_LEFT_JOY_Y, joy_map[1].value);
+  predict_update(now);
+
+  for (int i = 0; i < INPUT_MUX_COUNT; i++)
+  {
+    snapshot.mux[i] = analog[ANALOG_MUX_FIRST + i];
+  }
+  snapshot.sample_us = now;
+  snapshot.valid = true;
+}
+
+static void input_convert(void)
+{
+  if (!acquiring) return;
+
+  uint32_t const now = time_us_32();
+  convert_pins();
+  convert_sticks(now);
+  convert_buttons(now);
+}
+
+//----------------------- Sample Handlers -----------------------//
+// These run in the sampling scheduler's alarm interrupt, except for the first round, which
+// input_task() runs directly before starting the scheduler.
+
+// The on-chip temperature sensor, for the stick temperature model
+static void sample_temperature(uint32_t now)
+{
+  (void) now;
+  uint16_t adc[ACQUIRE_ADC_MAX];
+  acquire_adc_latest(adc);
+  tempco_sample(adc_correct(adc[ANALOG_TEMPERATURE]));
+}
+
+// Slow estimators and flash saves must not run in the interrupt; flag them for input_task()
+static volatile bool housekeeping_due;
+
+static void sample_housekeeping(uint32_t now)
+{
+  (void) now;
+  housekeeping_due = true;
+}
+
+static const sampler_source _sampler_config[] =
+{
+  { sample_housekeeping, SAMPLE_RATE_HOUSEKEEPING_HZ },
+  { sample_temperature,  SAMPLE_RATE_TEMPERATURE_HZ  },
+};
+
+// Start acquisition and run the housekeeping the sampler asks for
+// The first call brings up the ADC, starts DMA acquisition, converts the first block (temperature
+// first, so the drift tracker starts from a compensated center) and starts the sampling scheduler.
+// Later calls convert the newest block and run the slow estimators and the batched flash saves.
+void input_task(void)
+{
+  if (!acquiring)  // Deferred from boot so it does not delay tusb_init()
+  {
+    setup_controller_analog();
+    button_stats_init(_button_config_count);  // Load the saved button actuation counters
+    acquire_start(_analog_config, (uint8_t) _analog_config_count);
+    acquiring = true;
+    sample_temperature(time_us_32());
+    input_convert();
+    sampler_start(_sampler_config, count_of(_sampler_config));
+    boot_profile_mark(BOOT_MARK_INPUT_READY);
+  }
+
+  if (housekeeping_due)
+  {
+    housekeeping_due = false;
+    cpu_load_enter();
+    input_convert();
+    axis_health_sample(snapshot.axis_raw, drift_at_rest());
+    drift_tick(snapshot.axis_raw);
+    button_stats_poll(time_us_32());
+    cpu_load_exit();
+  }
+}
+
+const input_snapshot_t *input_snapshot(void)
+{
+  return &snapshot;
+}
+
+// Converts the newest acquisition block for a report built outside this file (the other personalities,
+// personality.h). Returns NULL before the first complete sample.
+const input_snapshot_t *input_refresh(void)
+{
+  input_convert();
+  return snapshot.valid ? &snapshot : NULL;
+}
+
+//----------------------- Stick Directions -----------------------//
+// A direction is down once the left stick is more than STICK_DIRECTION_PRESS codes from center on that
+// side and up again below STICK_DIRECTION_RELEASE, so a stick resting near the threshold does not
+// chatter. `held` is the previous result (bit per stick_direction); the caller keeps it.
+#define STICK_DIRECTION_PRESS    1024  // Half way out
+#define STICK_DIRECTION_RELEASE  768
+
+uint32_t input_stick_directions(const input_snapshot_t *input, uint32_t held)
+{
+  int32_t const dx = (int32_t) input->axis[ADC_LEFT_JOY_X] - 2048;
+  int32_t const dy = (int32_t) input->axis[ADC_LEFT_JOY_Y] - 2048;
+  int32_t const side[STICK_DIRECTIONS] = { [STICK_LEFT] = -dx, [STICK_RIGHT] = dx, [STICK_UP] = -dy, [STICK_DOWN] = dy };
+
+  uint32_t next = 0;
+  for (int d = 0; d < STICK_DIRECTIONS; d++)
+  {
+    int32_t const threshold = (held & (1u << d)) ? STICK_DIRECTION_RELEASE : STICK_DIRECTION_PRESS;
+    if (side[d] >= threshold) next |= 1u << d;
+  }
+  return next;
+}
+
+//----------------------- Output Quantizer -----------------------//
+// A resting stick sits on the boundary between two 8-bit report values and flickers between them,
+// which makes every report look "changed". Each report axis keeps its last emitted value and only moves once
+// the 12-bit input leaves that value's 16-code bucket by more than `band` codes. Outputs that would
+// have changed without the band are counted as suppressed.
+#define AXIS_HYSTERESIS_DEFAULT 4  // ADC codes on each side of the bucket, 1/4 of an output step
+
+typedef struct
+{
+  uint8_t out;           // Last emitted 8-bit value
+  uint8_t band;          // Hysteresis in ADC codes
+  uint32_t suppressed;   // Output changes held back by the band
+} axis_quantizer;
+
+static axis_quantizer quantizer[REPORT_AXIS_COUNT] =
+{
+  [MIX_OUT_X]  = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+  [MIX_OUT_Y]  = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+  [MIX_OUT_Z]  = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+  [MIX_OUT_RZ] = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+  [MIX_OUT_RX] = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+  [MIX_OUT_RY] = { .out = 0x80, .band = AXIS_HYSTERESIS_DEFAULT },
+};
+
+_Static_assert(MIX_OUTPUT_COUNT == REPORT_AXIS_COUNT, "one quantizer per report axis");
+
+static uint8_t quantize_axis(axis_quantizer *q, uint16_t in)
+{
+  int32_t const lo = (q->out << 4) - q->band;
+  int32_t const hi = (q->out << 4) + 15 + q->band;
+  uint8_t const next = in > 4095 ? 255 : in >> 4;   // Saturate rather than wrap past 12 bits
+
+  bool const move = (int32_t) in < lo || (int32_t) in > hi;
+  q->suppressed += !move & (next != q->out);
+  q->out = move ? next : q->out;
+  return q->out;
+}
+
+void input_set_hysteresis(uint8_t axis, uint8_t band)
+{
+  if (axis < REPORT_AXIS_COUNT) quantizer[axis].band = band;
+}
 
-   //----------------------- Input Devices (Joystick) -----------------------//
-  // Read joystick ADC values
-  // The joystick is an analog input device. We use the ADC (Analog-to-Digital Converter) to read its position.
-  adc_select_input(0);           // Select ADC input 0 (X-axis, connected to GPIO 26)
-  joy_map[0].value = adc_read(); // Read the X-axis value (12-bit value between 0 and 4095)
+// Telemetry page: per report axis { u8 out, u8 band, u32 suppressed }, then u32 average poll delay (us)
+uint16_t input_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < REPORT_AXIS_COUNT * 6 + 4) return 0;
 
-  adc_select_input(1);           // Select ADC input 1 (Y-axis, connected to GPIO 27)
-  joy_map[1].value = adc_read(); // Read the Y-axis value (12-bit value between 0 and 4095)
+  for (int i = 0; i < REPORT_AXIS_COUNT; i++)
+  {
+    buf[i * 6] = quantizer[i].out;
+    buf[i * 6 + 1] = quantizer[i].band;
+    memcpy(&buf[i * 6 + 2], &quantizer[i].suppressed, 4);
+  }
+  memcpy(&buf[REPORT_AXIS_COUNT * 6], &poll_delay_us, 4);
+  return REPORT_AXIS_COUNT * 6 + 4;
+}
+
+// Telemetry page: u16 linearised value per mux channel
+uint16_t input_mux_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < sizeof(snapshot.mux)) return 0;
+
+  memcpy(buf, snapshot.mux, sizeof(snapshot.mux));
+  return sizeof(snapshot.mux);
+}
+
+//----------------------- Networks and the Internet (USB Communication) -----------------------//
+static void fill_report(hid_gamepad_report_t *report)
+{
+  report->buttons |= snapshot.buttons;
+
+  // Where the sticks will be when the host reads this report
+  uint32_t const read_at = time_us_32() + poll_delay_us;
+  uint16_t const stick[INPUT_AXIS_COUNT] =
+  {
+    [ADC_LEFT_JOY_X] = predictor_predict(&axis_predictor[ADC_LEFT_JOY_X], &predictor_cfg[ADC_LEFT_JOY_X], read_at),
+    [ADC_LEFT_JOY_Y] = predictor_predict(&axis_predictor[ADC_LEFT_JOY_Y], &predictor_cfg[ADC_LEFT_JOY_Y], read_at),
+  };
+
+  // Sticks and mux channels onto the report axes (mix_config.h)
+  uint16_t axes[MIX_OUTPUT_COUNT];
+  mixer_run(stick, snapshot.mux, axes);
 
   //----------------------- Data and Storage (Binary Representation) -----------------------//
   // Scale 12-bit ADC values to 8-bit range
   // The ADC produces a 12-bit value (0-4095). This value needs to be scaled down to 8 bits (0-255)
-  // to fit into the HID report format, which uses 8-bit fields for joystick positions.
-  report->x = joy_map[0].value / 16;  // Scale X-axis to 8-bit range
-  report->y = joy_map[1].value / 16;  // Scale Y-axis to 8-bit range
-}
\ No newline at end of file
+  // to fit into the HID report format, which uses 8-bit fields for joystick positions. The quantizer
+  // does the /16 and holds the value steady while the stick rests near a step. Axes without a mixer
+  // entry are left at 0; the conditions are constants, so unused axes cost nothing.
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_X))  report->x  = quantize_axis(&quantizer[MIX_OUT_X], axes[MIX_OUT_X]);    // Scale X-axis to 8-bit range
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_Y))  report->y  = quantize_axis(&quantizer[MIX_OUT_Y], axes[MIX_OUT_Y]);    // Scale Y-axis to 8-bit range
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_Z))  report->z  = quantize_axis(&quantizer[MIX_OUT_Z], axes[MIX_OUT_Z]);
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_RZ)) report->rz = quantize_axis(&quantizer[MIX_OUT_RZ], axes[MIX_OUT_RZ]);
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_RX)) report->rx = quantize_axis(&quantizer[MIX_OUT_RX], axes[MIX_OUT_RX]);
+  if (MIX_OUTPUT_USED & (1u << MIX_OUT_RY)) report->ry = quantize_axis(&quantizer[MIX_OUT_RY], axes[MIX_OUT_RY]);
+}
+
+// Update the HID report for the controller
+// This function converts the newest acquisition block and copies the input snapshot into the gamepad
+// HID report, preparing a structured HID report to be sent to the host via USB. No hardware is touched here.
+void update_hid_report_controller(hid_gamepad_report_t *report)
+{
+  cpu_load_enter();
+  input_convert();
+  if (snapshot.valid) fill_report(report);
+  cpu_load_exit();
+}
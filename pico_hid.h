@@ -1,8 +1,49 @@
+#ifndef PICO_HID_H_
+#define PICO_HID_H_
+
 // #define JUST_STDIO
 
 #include "tusb.h"
+#include "predictor.h"
+
+// Latest converted state of all inputs, refreshed from the newest acquisition block (pico_hid.c) when a report is built
+#define INPUT_AXIS_COUNT 2  // Left joystick X and Y
+#define INPUT_MUX_COUNT  16 // Analog controls behind the mux
+#define REPORT_AXIS_COUNT 6 // Gamepad report axes x, y, z, rz, rx, ry (see mixer.h)
+
+typedef struct
+{
+  uint32_t buttons;                  // Gamepad button mask of the pressed buttons (debounced)
+  uint32_t pressed;                  // Pressed buttons before mapping, bit i = _button_config[i] (pico_hid.c)
+  uint16_t axis[INPUT_AXIS_COUNT];   // 12-bit value per axis, recentered with deadzone (2048 = center)
+  uint16_t axis_raw[INPUT_AXIS_COUNT];  // Linearised 12-bit ADC value per axis
+  uint16_t mux[INPUT_MUX_COUNT];     // Linearised 12-bit ADC value per analog mux channel
+  uint32_t sample_us;                // time_us_32() when a new stick block was last converted
+  uint32_t edge_us;                  // Capture time (time_us_32()) of the block where the last button change first showed
+  bool valid;                        // False until the first complete sample
+} input_snapshot_t;
+
+// Left stick pushed towards one side, for personalities with digital directions (input_stick_directions)
+typedef enum
+{
+  STICK_LEFT = 0,
+  STICK_RIGHT,
+  STICK_UP,     // Towards lower Y values
+  STICK_DOWN,
+  STICK_DIRECTIONS
+} stick_direction;
 
 void setup_controller_buttons(void);
+void input_task(void);
+const input_snapshot_t *input_snapshot(void);
+const input_snapshot_t *input_refresh(void);
+uint32_t input_stick_directions(const input_snapshot_t *input, uint32_t held);
 bool is_empty(const hid_gamepad_report_t *report);
 void update_hid_report_controller(hid_gamepad_report_t *report);
+void input_set_hysteresis(uint8_t axis, uint8_t band);
+uint16_t input_telemetry(uint8_t *buf, uint16_t len);
+uint16_t input_mux_telemetry(uint8_t *buf, uint16_t len);
+void input_set_predictor(uint8_t axis, const predictor_config *config);
+void input_poll_delay_sample(uint32_t delay_us);
 
+#endif /* PICO_HID_H_ */
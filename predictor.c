@@ -0,0 +1,78 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "predictor.h"
+
+void predictor_reset(predictor *p)
+{
+  p->primed = false;
+}
+
+static void restart(predictor *p, uint16_t z, uint32_t t_us)
+{
+  p->x_q8 = (int32_t) z << 8;
+  p->v_q8 = 0;
+  p->t_us = t_us;
+  p->z = z;
+  p->primed = true;
+}
+
+// Predict to the sample time, then correct position and velocity by the residual
+void predictor_update(predictor *p, const predictor_config *c, uint16_t z, uint32_t t_us)
+{
+  uint32_t dt = t_us - p->t_us;
+  if (!p->primed || dt > PREDICTOR_MAX_GAP_US)
+  {
+    restart(p, z, t_us);
+    return;
+  }
+  if (dt == 0) dt = 1;
+
+  int32_t const predicted = p->x_q8 + (int32_t) ((int64_t) p->v_q8 * dt / 1000);
+  int32_t const residual = ((int32_t) z << 8) - predicted;
+
+  p->x_q8 = predicted + (int32_t) (((int64_t) c->alpha_q8 * residual) >> 8);
+  p->v_q8 += (int32_t) ((int64_t) c->beta_q8 * residual * 1000 / ((int64_t) dt << 8));
+  p->t_us = t_us;
+  p->z = z;
+}
+
+// Position at `at_us`, within the horizon and overshoot limits
+uint16_t predictor_predict(const predictor *p, const predictor_config *c, uint32_t at_us)
+{
+  if (!p->primed || c->horizon_us == 0) return p->z;
+
+  int32_t ahead = (int32_t) (at_us - p->t_us);
+  if (ahead < 0) ahead = 0;
+  if (ahead > c->horizon_us) ahead = c->horizon_us;
+
+  int32_t out = (p->x_q8 + (int32_t) ((int64_t) p->v_q8 * ahead / 1000) + 128) >> 8;
+
+  int32_t const lo = (int32_t) p->z - c->overshoot;
+  int32_t const hi = (int32_t) p->z + c->overshoot;
+  out = out < lo ? lo : out > hi ? hi : out;
+  out = out < 0 ? 0 : out > PREDICTOR_CODE_MAX ? PREDICTOR_CODE_MAX : out;
+  return (uint16_t) out;
+}
@@ -0,0 +1,67 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PREDICTOR_H_
+#define PREDICTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Stick Position Predictor -----------------------//
+// Fixed-point alpha-beta filter per axis. Every new sample updates a position and velocity estimate;
+// when a report is built the axis is extrapolated to the time the host is expected to read it, which
+// hides part of the sample-to-host latency.
+//
+// The extrapolation is limited to `horizon_us` ahead of the last sample and to `overshoot` codes away
+// from it, so a stick that stops hard does not fly past its end position. horizon_us = 0 turns the
+// predictor off for that axis: the last sample is passed through unchanged.
+//
+// Plain C without SDK dependencies: tools/predict_sim.c builds this file on the host to replay
+// recorded stick traces and measure the prediction error of a configuration.
+#define PREDICTOR_MAX_GAP_US 20000  // A longer gap between samples restarts the filter
+#define PREDICTOR_CODE_MAX   4095
+
+typedef struct
+{
+  uint8_t alpha_q8;     // Position gain, 1/256 (0-255)
+  uint8_t beta_q8;      // Velocity gain, 1/256 (0-255)
+  uint16_t horizon_us;  // Longest extrapolation, 0 = predictor off
+  uint16_t overshoot;   // Largest distance from the last sample, ADC codes
+} predictor_config;
+
+typedef struct
+{
+  int32_t x_q8;         // Position estimate, 1/256 code
+  int32_t v_q8;         // Velocity estimate, 1/256 code per ms
+  uint32_t t_us;        // Time of the last sample
+  uint16_t z;           // Last sample
+  bool primed;
+} predictor;
+
+void predictor_reset(predictor *p);
+void predictor_update(predictor *p, const predictor_config *c, uint16_t z, uint32_t t_us);
+uint16_t predictor_predict(const predictor *p, const predictor_config *c, uint32_t at_us);
+
+#endif /* PREDICTOR_H_ */
@@ -0,0 +1,111 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "quadrature.h"
+
+#define QUADRATURE_PIO pio1  // pio0 belongs to the acquisition (acquire.c)
+
+//----------------------- PIO Program -----------------------//
+// Keeps the last pin state in OSR and the count in Y. Every pass shifts the last and the new state of
+// both phases into ISR and jumps straight to the 4-bit value: the jump table at address 0 turns each
+// transition into "no change", "increment" or "decrement" (so the program must be loaded at 0). The
+// count is pushed on every pass without blocking; the CPU drains the RX FIFO and takes a fresh value.
+// The longest pass is 10 cycles.
+#define ENC_UPDATE     15
+#define ENC_DECREMENT  14
+#define ENC_INCREMENT  21
+
+static uint16_t encoder_instructions[24];
+static const pio_program_t encoder_program = { encoder_instructions, 24, 0 };
+static bool loaded;
+
+static void encoder_load(void)
+{
+  // Jump table: index = last state << 2 | new state. Entries 14 and 15 are the decrement and
+  // update steps themselves (11 -> 10 and 11 -> 11).
+  static const uint8_t table[14] =
+  {
+    ENC_UPDATE, ENC_DECREMENT, ENC_INCREMENT, ENC_UPDATE,   // from 00
+    ENC_INCREMENT, ENC_UPDATE, ENC_UPDATE, ENC_DECREMENT,   // from 01
+    ENC_DECREMENT, ENC_UPDATE, ENC_UPDATE, ENC_INCREMENT,   // from 10
+    ENC_UPDATE, ENC_INCREMENT,                              // from 11
+  };
+  for (uint i = 0; i < 14; i++) encoder_instructions[i] = (uint16_t) pio_encode_jmp(table[i]);
+
+  encoder_instructions[14] = (uint16_t) pio_encode_jmp_y_dec(ENC_UPDATE);       // decrement: jmp y-- update
+  encoder_instructions[15] = (uint16_t) pio_encode_mov(pio_isr, pio_y);         // update: mov isr, y
+  encoder_instructions[16] = (uint16_t) pio_encode_push(false, false);          // push noblock
+  encoder_instructions[17] = (uint16_t) pio_encode_out(pio_isr, 2);             // out isr, 2
+  encoder_instructions[18] = (uint16_t) pio_encode_in(pio_pins, 2);             // in pins, 2
+  encoder_instructions[19] = (uint16_t) pio_encode_mov(pio_osr, pio_isr);       // mov osr, isr
+  encoder_instructions[20] = (uint16_t) pio_encode_mov(pio_pc, pio_isr);        // mov pc, isr
+  encoder_instructions[21] = (uint16_t) pio_encode_mov_not(pio_y, pio_y);       // increment: mov y, ~y
+  encoder_instructions[22] = (uint16_t) pio_encode_jmp_y_dec(23);               // jmp y-- next
+  encoder_instructions[23] = (uint16_t) pio_encode_mov_not(pio_y, pio_y);       // mov y, ~y (wrap)
+
+  pio_add_program_at_offset(QUADRATURE_PIO, &encoder_program, 0);
+  loaded = true;
+}
+
+//----------------------- Encoders -----------------------//
+int quadrature_start(uint8_t pin_a)
+{
+  if (!loaded) encoder_load();
+  uint const sm = (uint) pio_claim_unused_sm(QUADRATURE_PIO, true);
+
+  for (uint i = 0; i < 2; i++)
+  {
+    gpio_init(pin_a + i);
+    gpio_pull_up(pin_a + i);
+  }
+  pio_sm_set_consecutive_pindirs(QUADRATURE_PIO, sm, pin_a, 2, false);
+
+  pio_sm_config c = pio_get_default_sm_config();
+  sm_config_set_wrap(&c, ENC_UPDATE, 23);
+  sm_config_set_in_pins(&c, pin_a);
+  sm_config_set_in_shift(&c, false, false, 32);   // New state into ISR[1:0]
+  sm_config_set_out_shift(&c, true, false, 32);   // Last state from OSR[1:0]
+  sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+  pio_sm_init(QUADRATURE_PIO, sm, ENC_UPDATE, &c);
+
+  // Start from the current pin state, so the first pass does not count a step
+  pio_sm_exec(QUADRATURE_PIO, sm, pio_encode_in(pio_pins, 2));
+  pio_sm_exec(QUADRATURE_PIO, sm, pio_encode_mov(pio_osr, pio_isr));
+  pio_sm_set_enabled(QUADRATURE_PIO, sm, true);
+  return (int) sm;
+}
+
+// Current count: everything in the FIFO may be stale, the value pushed after draining it is not
+int32_t quadrature_count(int encoder)
+{
+  uint32_t value = 0;
+  for (uint n = pio_sm_get_rx_fifo_level(QUADRATURE_PIO, (uint) encoder) + 1; n > 0; n--)
+  {
+    value = pio_sm_get_blocking(QUADRATURE_PIO, (uint) encoder);
+  }
+  return (int32_t) value;
+}
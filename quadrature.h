@@ -0,0 +1,42 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef QUADRATURE_H_
+#define QUADRATURE_H_
+
+#include <stdint.h>
+
+//----------------------- Quadrature Counter -----------------------//
+// Counts optical quadrature encoders (wheel, trackball) in PIO: one state machine per encoder keeps a
+// 32-bit position, at up to sys_clk / 10 steps per second, far beyond any wheel or trackball. The CPU
+// only reads the position, so no step is ever lost however seldom it is read; differences of two
+// readings are correct across the 32-bit wrap.
+#define QUADRATURE_MAX 4  // State machines of the PIO block
+
+// Starts counting phase A on `pin_a` and phase B on the next pin (both pulled up); returns the encoder
+int quadrature_start(uint8_t pin_a);
+int32_t quadrature_count(int encoder);
+
+#endif /* QUADRATURE_H_ */
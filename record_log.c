@@ -0,0 +1,137 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "flash_store.h"
+#include "crc32.h"
+#include "record_log.h"
+
+// Record: header, payload, and a CRC-32 of everything before it in the last four bytes
+typedef struct
+{
+  uint32_t seq;
+  uint16_t len;
+  uint16_t reserved;
+} log_header;
+
+static uint8_t page[FLASH_PAGE_SIZE];
+
+static uint16_t slots(const record_log *log)
+{
+  return FLASH_SECTOR_SIZE / log->size;
+}
+
+static const uint8_t *slot_ptr(const record_log *log, uint8_t sector, uint16_t slot)
+{
+  return flash_store_ptr(log->offset + sector * FLASH_SECTOR_SIZE + slot * log->size);
+}
+
+static bool slot_blank(const record_log *log, const uint8_t *rec)
+{
+  const uint32_t *words = (const uint32_t *) rec;
+  for (unsigned i = 0; i < log->size / 4u; i++)
+  {
+    if (words[i] != 0xFFFFFFFFu) return false;
+  }
+  return true;
+}
+
+static bool slot_valid(const record_log *log, const uint8_t *rec)
+{
+  const log_header *hdr = (const log_header *) rec;
+  uint32_t crc;
+  memcpy(&crc, rec + log->size - 4, 4);
+  return hdr->len <= log->size - RECORD_LOG_OVERHEAD && crc32_update(0, rec, log->size - 4) == crc;
+}
+
+bool record_log_open(record_log *log, uint32_t offset, uint16_t record_size, void *payload, uint16_t len)
+{
+  const uint8_t *newest = NULL;
+
+  log->offset = offset;
+  log->size = record_size;
+  log->seq = 0;
+  log->sector = 0;
+
+  for (uint8_t sector = 0; sector < 2; sector++)
+  {
+    for (uint16_t slot = 0; slot < slots(log); slot++)
+    {
+      const uint8_t *rec = slot_ptr(log, sector, slot);
+      if (!slot_valid(log, rec)) continue;
+
+      uint32_t const seq = ((const log_header *) rec)->seq;
+      if (newest == NULL || (int32_t) (seq - log->seq) > 0)
+      {
+        newest = rec;
+        log->seq = seq;
+        log->sector = sector;
+      }
+    }
+  }
+
+  // Append after the last used slot of the active sector (a torn record also counts as used)
+  log->next = slots(log);
+  while (log->next > 0 && slot_blank(log, slot_ptr(log, log->sector, log->next - 1))) log->next--;
+
+  if (newest == NULL) return false;
+
+  uint16_t const stored = ((const log_header *) newest)->len;
+  memset(payload, 0, len);
+  memcpy(payload, newest + sizeof(log_header), stored < len ? stored : len);
+  return true;
+}
+
+void record_log_append(record_log *log, const void *payload, uint16_t len)
+{
+  if (len > log->size - RECORD_LOG_OVERHEAD) len = log->size - RECORD_LOG_OVERHEAD;
+
+  if (log->next >= slots(log))
+  {
+    log->sector ^= 1;
+    flash_store_erase(log->offset + log->sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    log->next = 0;
+  }
+
+  // Build the record in place in a page of 0xFF; programming 0xFF leaves the neighbouring records
+  // untouched
+  uint32_t const at = log->sector * FLASH_SECTOR_SIZE + log->next * log->size;
+  uint8_t *rec = &page[at % FLASH_PAGE_SIZE];
+  log_header const hdr = { .seq = log->seq + 1, .len = len };
+
+  memset(page, 0xFF, sizeof(page));
+  memset(rec, 0, log->size);
+  memcpy(rec, &hdr, sizeof(hdr));
+  memcpy(rec + sizeof(hdr), payload, len);
+  uint32_t const crc = crc32_update(0, rec, log->size - 4);
+  memcpy(rec + log->size - 4, &crc, 4);
+  flash_store_program(log->offset + at - at % FLASH_PAGE_SIZE, page, FLASH_PAGE_SIZE);
+
+  log->seq = hdr.seq;
+  log->next++;
+}
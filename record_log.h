@@ -0,0 +1,61 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef RECORD_LOG_H_
+#define RECORD_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/flash.h"
+
+//----------------------- Flash Record Log -----------------------//
+// Append-only log of fixed-size records in two flash sectors, for state that is saved often (drift
+// estimates, counters). Each save appends one record instead of erasing, so a sector takes
+// FLASH_SECTOR_SIZE / record_size saves per erase. When the active sector is full the other one is erased and the
+// log continues there; the newest record always survives in the full sector until its successor is
+// written. A record carries a sequence number and a CRC, so a save cut short by a reset is ignored
+// and the previous record is used.
+//
+// The record size is a power of two from 64 bytes up to a flash page; each record loses
+// RECORD_LOG_OVERHEAD bytes to its header and CRC.
+#define RECORD_LOG_RECORD_SIZE  64                 // Default record size
+#define RECORD_LOG_OVERHEAD     12
+#define RECORD_LOG_PAYLOAD_MAX  (RECORD_LOG_RECORD_SIZE - RECORD_LOG_OVERHEAD)
+#define RECORD_LOG_SIZE         (2 * FLASH_SECTOR_SIZE)
+
+typedef struct
+{
+  uint32_t offset;   // Flash offset of the two-sector region
+  uint32_t seq;      // Sequence number of the newest record
+  uint16_t size;     // Record size in bytes
+  uint16_t next;     // Next free slot in the active sector
+  uint8_t sector;    // Active sector, 0 or 1
+} record_log;
+
+// Scan the region; copies the newest valid payload and returns true if there is one
+bool record_log_open(record_log *log, uint32_t offset, uint16_t record_size, void *payload, uint16_t len);
+void record_log_append(record_log *log, const void *payload, uint16_t len);
+
+#endif /* RECORD_LOG_H_ */
@@ -0,0 +1,148 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "sampler.h"
+#include "cpu_load.h"
+
+static const sampler_source *sources;
+static uint8_t source_count;
+
+static uint8_t phase_table[SAMPLER_MAX_FRAME];   // Bit i set: source i samples on this tick
+static uint16_t frame_ticks;
+static uint32_t tick_us;
+
+static int alarm_num = -1;
+static uint64_t target_us;
+static uint16_t phase;
+
+static uint32_t ticks;
+static uint32_t skipped_ticks;
+static uint32_t max_handler_us;
+
+// Place each source on the phase whose ticks are least loaded so far, fastest sources first
+static void build_phase_table(void)
+{
+  static uint8_t load[SAMPLER_MAX_FRAME];  // Sources per tick so far (static: keeps 1 KB off the stack)
+  uint8_t order[SAMPLER_MAX_SOURCES];
+
+  for (uint8_t i = 0; i < source_count; i++) order[i] = i;
+  for (uint8_t i = 1; i < source_count; i++)  // Insertion sort by rate, descending
+  {
+    for (uint8_t j = i; j > 0 && sources[order[j]].rate_hz > sources[order[j - 1]].rate_hz; j--)
+    {
+      uint8_t const t = order[j]; order[j] = order[j - 1]; order[j - 1] = t;
+    }
+  }
+
+  memset(phase_table, 0, sizeof(phase_table));
+  for (uint8_t n = 0; n < source_count; n++)
+  {
+    uint8_t const i = order[n];
+    uint16_t const period = (uint16_t) (1000000u / tick_us / sources[i].rate_hz);
+
+    uint16_t best = 0;
+    uint8_t best_load = UINT8_MAX;
+    for (uint16_t p = 0; p < period; p++)
+    {
+      uint8_t worst = 0;
+      for (uint16_t t = p; t < frame_ticks; t += period) worst = load[t] > worst ? load[t] : worst;
+      if (worst < best_load) { best_load = worst; best = p; }
+    }
+
+    for (uint16_t t = best; t < frame_ticks; t += period)
+    {
+      phase_table[t] |= 1u << i;
+      load[t]++;
+    }
+  }
+}
+
+static void sampler_alarm(uint alarm)
+{
+  cpu_load_enter();
+  uint32_t const now = time_us_32();
+
+  uint8_t due = phase_table[phase];
+  for (uint8_t i = 0; due; i++, due >>= 1)
+  {
+    if (due & 1) sources[i].sample(now);
+  }
+
+  uint32_t const spent = time_us_32() - now;
+  if (spent > max_handler_us) max_handler_us = spent;
+  ticks++;
+
+  // Next tick on the fixed grid; hardware_alarm_set_target() returns true if it is already past
+  for (;;)
+  {
+    target_us += tick_us;
+    phase = phase + 1 == frame_ticks ? 0 : phase + 1;
+    if (!hardware_alarm_set_target(alarm, from_us_since_boot(target_us))) break;
+    skipped_ticks++;
+  }
+  cpu_load_exit();
+}
+
+// Sources are indexed in the order given; the table must stay valid while the sampler runs
+void sampler_start(const sampler_source *src, uint8_t count)
+{
+  uint32_t fastest = 0, slowest = UINT32_MAX;
+
+  sources = src;
+  source_count = count < SAMPLER_MAX_SOURCES ? count : SAMPLER_MAX_SOURCES;
+  for (uint8_t i = 0; i < source_count; i++)
+  {
+    if (src[i].rate_hz > fastest) fastest = src[i].rate_hz;
+    if (src[i].rate_hz < slowest) slowest = src[i].rate_hz;
+  }
+
+  tick_us = 1000000u / fastest;
+  frame_ticks = (uint16_t) (fastest / slowest);
+  if (frame_ticks > SAMPLER_MAX_FRAME) frame_ticks = SAMPLER_MAX_FRAME;
+  build_phase_table();
+
+  alarm_num = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(alarm_num, sampler_alarm);
+  target_us = time_us_64() + tick_us;
+  phase = 0;
+  hardware_alarm_set_target(alarm_num, from_us_since_boot(target_us));
+}
+
+// Telemetry page: u32 base tick (us), u16 frame ticks, u32 ticks, u32 skipped ticks,
+// u32 longest tick (us)
+uint16_t sampler_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 18) return 0;
+
+  memcpy(&buf[0], &tick_us, 4);
+  memcpy(&buf[4], &frame_ticks, 2);
+  memcpy(&buf[6], &ticks, 4);
+  memcpy(&buf[10], &skipped_ticks, 4);
+  memcpy(&buf[14], &max_handler_us, 4);
+  return 18;
+}
@@ -0,0 +1,57 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include <stdint.h>
+
+//----------------------- Multi-rate Sampling Scheduler -----------------------//
+// Runs every input source at its own rate from one hardware alarm. The alarm fires at the rate of
+// the fastest source (the base tick); a phase table built once at start-up holds, for every tick of
+// the frame, the set of sources that sample on that tick. The frame is one period of the slowest
+// source, so each tick costs one table load and the handlers that are due.
+//
+// Sources with the same period are given different phases where possible, so the slow work is
+// spread over the frame instead of piling up on tick 0. Every rate must divide the base rate, and
+// every period must divide the frame.
+//
+// Handlers run in the alarm interrupt. When a tick is serviced late (interrupts were off during a
+// flash write) the missed ticks are skipped and counted, the grid does not move.
+#define SAMPLER_MAX_SOURCES  8
+#define SAMPLER_MAX_FRAME    1024   // Ticks per frame (base rate / slowest rate)
+
+typedef void (*sampler_fn)(uint32_t now_us);
+
+typedef struct
+{
+  sampler_fn sample;
+  uint32_t rate_hz;
+} sampler_source;
+
+void sampler_start(const sampler_source *sources, uint8_t count);
+uint16_t sampler_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* SAMPLER_H_ */
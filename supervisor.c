@@ -0,0 +1,133 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "supervisor.h"
+
+// Scratch registers 0-3 are free for the application (the SDK uses 4-7 for watchdog_reboot)
+#define SCRATCH_STAGE     0  // SUPERVISOR_MAGIC | stage
+#define SCRATCH_STAGE_US  1  // time_us_32() when the stage was entered
+#define SCRATCH_FEED_US   2  // time_us_32() of the last feed
+#define SCRATCH_HANGS     3  // Number of watchdog resets since power-on
+
+#define SUPERVISOR_MAGIC  0x5AFE0000u
+#define MAGIC_MASK        0xFFFF0000u
+
+typedef enum
+{
+  RESET_POWER_ON = 0,   // Cold boot or external reset
+  RESET_WATCHDOG,       // Hang detected, diagnostic state below is valid
+  RESET_REQUESTED,      // watchdog_reboot() or another deliberate reboot
+} reset_reason;
+
+typedef struct
+{
+  uint8_t reason;        // reset_reason of this boot
+  uint8_t stage;         // Stage the previous run was stuck in
+  uint32_t stage_us;     // When that stage was entered
+  uint32_t feed_us;      // Last successful feed
+  uint32_t hang_count;   // Watchdog resets since power-on
+} crash_info;
+
+static crash_info last_crash;
+static uint32_t fed_sample_us = 0;  // Sample timestamp seen at the last feed
+static bool running = false;
+
+// Collect the previous run's diagnostic state. Call first thing in main, before anything touches
+// the scratch registers.
+void supervisor_init(void)
+{
+  bool const valid = (watchdog_hw->scratch[SCRATCH_STAGE] & MAGIC_MASK) == SUPERVISOR_MAGIC;
+  uint32_t hangs = valid ? watchdog_hw->scratch[SCRATCH_HANGS] : 0;
+
+  if (watchdog_enable_caused_reboot() && valid)
+  {
+    last_crash.reason = RESET_WATCHDOG;
+    last_crash.stage = (uint8_t) watchdog_hw->scratch[SCRATCH_STAGE];
+    last_crash.stage_us = watchdog_hw->scratch[SCRATCH_STAGE_US];
+    last_crash.feed_us = watchdog_hw->scratch[SCRATCH_FEED_US];
+    hangs++;
+  }
+  else
+  {
+    last_crash.reason = watchdog_caused_reboot() ? RESET_REQUESTED : RESET_POWER_ON;
+  }
+  last_crash.hang_count = hangs;
+
+  watchdog_hw->scratch[SCRATCH_HANGS] = hangs;
+  supervisor_stage_enter(SUPERVISOR_STAGE_BOOT);
+}
+
+// Arm the watchdog. Called once boot setup is done and the superloop is about to start.
+void supervisor_start(void)
+{
+  watchdog_enable(SUPERVISOR_TIMEOUT_MS, true);  // Paused while a debugger halts the core
+  running = true;
+}
+
+void supervisor_stage_enter(supervisor_stage stage)
+{
+  watchdog_hw->scratch[SCRATCH_STAGE] = SUPERVISOR_MAGIC | stage;
+  watchdog_hw->scratch[SCRATCH_STAGE_US] = time_us_32();
+}
+
+// Feed the watchdog if the input pipeline produced a new sample since the previous feed
+void supervisor_progress(uint32_t sample_us)
+{
+  if (!running || sample_us == fed_sample_us) return;
+
+  fed_sample_us = sample_us;
+  watchdog_hw->scratch[SCRATCH_FEED_US] = time_us_32();
+  watchdog_update();
+}
+
+// Flash erase/program stalls the whole chip for tens of milliseconds; widen the deadline around it
+void supervisor_begin_long_operation(void)
+{
+  supervisor_stage_enter(SUPERVISOR_STAGE_LONG_OPERATION);
+  if (running) watchdog_enable(SUPERVISOR_LONG_TIMEOUT_MS, true);
+}
+
+void supervisor_end_long_operation(void)
+{
+  if (running) watchdog_enable(SUPERVISOR_TIMEOUT_MS, true);
+}
+
+//----------------------- Telemetry -----------------------//
+// Page layout (little-endian):
+//   u8 reset_reason, u8 stuck_stage, u32 stage_entered_us, u32 last_feed_us, u32 hang_count
+uint16_t supervisor_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 14) return 0;
+
+  buf[0] = last_crash.reason;
+  buf[1] = last_crash.stage;
+  memcpy(&buf[2], &last_crash.stage_us, 4);
+  memcpy(&buf[6], &last_crash.feed_us, 4);
+  memcpy(&buf[10], &last_crash.hang_count, 4);
+  return 14;
+}
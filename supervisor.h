@@ -0,0 +1,63 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Hang Supervisor -----------------------//
+// The hardware watchdog resets the chip if the superloop stops making progress (a stuck adc_read,
+// a runaway callback, a HardFault spin). It is fed only by supervisor_progress(), which requires a
+// fresh input sample since the previous feed, so a loop that spins without sampling still resets.
+//
+// Before each stage of the loop the stage number and a timestamp are stored in the watchdog scratch
+// registers, which survive the watchdog reset. On the next boot supervisor_init() picks them up and
+// publishes them on the supervisor telemetry page.
+#define SUPERVISOR_TIMEOUT_MS       25    // Normal loop deadline, keeps hang-to-re-enumeration well under 100 ms
+#define SUPERVISOR_LONG_TIMEOUT_MS  2000  // Deadline while a known long operation (flash erase) runs
+
+typedef enum
+{
+  SUPERVISOR_STAGE_BOOT = 0,
+  SUPERVISOR_STAGE_TUD_TASK,
+  SUPERVISOR_STAGE_INPUT_TASK,
+  SUPERVISOR_STAGE_LED_TASK,
+  SUPERVISOR_STAGE_HID_TASK,
+  SUPERVISOR_STAGE_USB_COMMAND,
+  SUPERVISOR_STAGE_FW_UPDATE,
+  SUPERVISOR_STAGE_LONG_OPERATION,
+} supervisor_stage;
+
+void supervisor_init(void);
+void supervisor_start(void);
+void supervisor_stage_enter(supervisor_stage stage);
+void supervisor_progress(uint32_t sample_us);
+void supervisor_begin_long_operation(void);
+void supervisor_end_long_operation(void);
+uint16_t supervisor_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* SUPERVISOR_H_ */
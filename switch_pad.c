@@ -0,0 +1,97 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include "pico/stdlib.h"
+#include "switch_pad.h"
+#include "cpu_load.h"
+
+typedef struct
+{
+  uint8_t button;  // Entry of _button_config (pico_hid.c)
+  uint16_t mask;   // SWITCH_BUTTON_*
+} switch_button_map;
+
+// Button configuration, Switch face buttons by position (South = B, East = A)
+static const switch_button_map _switch_button_config[] = {
+    {0, SWITCH_BUTTON_B},      // South
+    {1, SWITCH_BUTTON_A},      // East
+    {2, SWITCH_BUTTON_X},      // North
+    {3, SWITCH_BUTTON_Y},      // West
+    {4, SWITCH_BUTTON_HOME},   // Mode
+    {5, SWITCH_BUTTON_MINUS},  // Select
+    {6, SWITCH_BUTTON_PLUS},   // Start
+};
+
+// D-pad buttons, entries of _button_config; SWITCH_HAT_UNUSED where the panel has none
+#define SWITCH_HAT_UNUSED UINT8_MAX
+
+enum { HAT_UP = 0, HAT_DOWN, HAT_LEFT, HAT_RIGHT, HAT_DIRECTIONS };
+
+static const uint8_t _switch_hat_config[HAT_DIRECTIONS] = {
+    [HAT_UP] = SWITCH_HAT_UNUSED,
+    [HAT_DOWN] = SWITCH_HAT_UNUSED,
+    [HAT_LEFT] = SWITCH_HAT_UNUSED,
+    [HAT_RIGHT] = SWITCH_HAT_UNUSED,
+};
+
+// Hat value for every combination of up | down << 1 | left << 2 | right << 3. Opposite directions
+// held together cancel out (up + down = neither), as on a stick lever.
+static const uint8_t hat_table[16] =
+{
+  SWITCH_HAT_NEUTRAL, 0, 4, SWITCH_HAT_NEUTRAL,   // -, U, D, U+D
+  6, 7, 5, 6,                                     // L, L+U, L+D, L+U+D
+  2, 1, 3, 2,                                     // R, R+U, R+D, R+U+D
+  SWITCH_HAT_NEUTRAL, 0, 4, SWITCH_HAT_NEUTRAL,   // L+R, ...
+};
+
+static uint8_t hat_value(uint32_t pressed)
+{
+  uint32_t dirs = 0;
+  for (int d = 0; d < HAT_DIRECTIONS; d++)
+  {
+    uint8_t const b = _switch_hat_config[d];
+    if (b != SWITCH_HAT_UNUSED && (pressed & (1u << b))) dirs |= 1u << d;
+  }
+  return hat_table[dirs];
+}
+
+void switch_pad_update_report(hid_switch_report_t *report)
+{
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input)
+  {
+    uint16_t buttons = 0;
+    for (unsigned i = 0; i < count_of(_switch_button_config); i++)
+    {
+      if (input->pressed & (1u << _switch_button_config[i].button)) buttons |= _switch_button_config[i].mask;
+    }
+    report->buttons = buttons;
+    report->hat = hat_value(input->pressed);
+    report->lx = (uint8_t) (input->axis[0] >> 4);  // Left stick, 12 to 8 bits
+    report->ly = (uint8_t) (input->axis[1] >> 4);
+  }
+  cpu_load_exit();
+}
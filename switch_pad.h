@@ -0,0 +1,79 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef SWITCH_PAD_H_
+#define SWITCH_PAD_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- Switch Personality -----------------------//
+// Presents the controller as a HORI Pokken Tournament Pro Pad, which the Nintendo Switch accepts as a
+// wired pad: its VID/PID, its report descriptor (no report IDs) and an interrupt OUT endpoint next to
+// the IN one. Buttons and the hat come from the same debounced snapshot as every other personality,
+// through their own mapping (_switch_button_config, _switch_hat_config in switch_pad.c).
+//
+// The descriptor has room for nothing else, so the vendor feature reports (telemetry, calibration,
+// firmware update) are not available in this personality; use the gamepad personality for them.
+#define SWITCH_VID               0x0F0D  // HORI
+#define SWITCH_PID               0x0092  // Pokken Tournament Pro Pad
+#define SWITCH_POLL_INTERVAL_MS  5       // bInterval of the original pad
+#define SWITCH_REPORT_SIZE       8
+
+// Button bits of the report
+#define SWITCH_BUTTON_Y        0x0001
+#define SWITCH_BUTTON_B        0x0002
+#define SWITCH_BUTTON_A        0x0004
+#define SWITCH_BUTTON_X        0x0008
+#define SWITCH_BUTTON_L        0x0010
+#define SWITCH_BUTTON_R        0x0020
+#define SWITCH_BUTTON_ZL       0x0040
+#define SWITCH_BUTTON_ZR       0x0080
+#define SWITCH_BUTTON_MINUS    0x0100
+#define SWITCH_BUTTON_PLUS     0x0200
+#define SWITCH_BUTTON_LCLICK   0x0400
+#define SWITCH_BUTTON_RCLICK   0x0800
+#define SWITCH_BUTTON_HOME     0x1000
+#define SWITCH_BUTTON_CAPTURE  0x2000
+
+#define SWITCH_HAT_NEUTRAL     0x08    // 0 = up, then clockwise in 45 degree steps
+#define SWITCH_STICK_CENTER    0x80
+
+typedef struct TU_ATTR_PACKED
+{
+  uint16_t buttons;  // SWITCH_BUTTON_*
+  uint8_t hat;
+  uint8_t lx;        // Sticks, 0x80 = center
+  uint8_t ly;
+  uint8_t rx;
+  uint8_t ry;
+  uint8_t vendor;
+} hid_switch_report_t;
+
+_Static_assert(sizeof(hid_switch_report_t) == SWITCH_REPORT_SIZE, "report layout of the original pad");
+
+void switch_pad_update_report(hid_switch_report_t *report);
+
+#endif /* SWITCH_PAD_H_ */
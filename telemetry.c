@@ -0,0 +1,104 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "telemetry.h"
+#include "mem_budget.h"
+#include "boot_profile.h"
+#include "supervisor.h"
+#include "pico_hid.h"
+#include "drift.h"
+#include "tempco.h"
+#include "axis_health.h"
+#include "periodic.h"
+#include "sampler.h"
+#include "acquire.h"
+#include "cpu_load.h"
+#include "wheel.h"
+#include "midi.h"
+#include "jvs.h"
+
+//----------------------- Page Table -----------------------//
+// One fill function per telemetry page, indexed by telemetry_page. Subsystems that want to publish
+// counters add a page number to the enum in telemetry.h and their fill function here.
+static const telemetry_page_fn _telemetry_pages[TELEMETRY_PAGE_COUNT] =
+{
+  [TELEMETRY_PAGE_MEMORY]     = mem_budget_telemetry,
+  [TELEMETRY_PAGE_BOOT]       = boot_profile_telemetry,
+  [TELEMETRY_PAGE_SUPERVISOR] = supervisor_telemetry,
+  [TELEMETRY_PAGE_INPUT]      = input_telemetry,
+  [TELEMETRY_PAGE_DRIFT]      = drift_telemetry,
+  [TELEMETRY_PAGE_TEMPCO]     = tempco_telemetry,
+  [TELEMETRY_PAGE_HEALTH]     = axis_health_telemetry,
+  [TELEMETRY_PAGE_TASKS]      = periodic_telemetry,
+  [TELEMETRY_PAGE_SAMPLER]    = sampler_telemetry,
+  [TELEMETRY_PAGE_ACQUIRE]    = acquire_telemetry,
+  [TELEMETRY_PAGE_CPU]        = cpu_load_telemetry,
+  [TELEMETRY_PAGE_MUX]        = input_mux_telemetry,
+  [TELEMETRY_PAGE_WHEEL]      = wheel_telemetry,
+  [TELEMETRY_PAGE_MIDI]       = midi_telemetry,
+  [TELEMETRY_PAGE_JVS]        = jvs_telemetry,
+};
+
+static uint8_t selected_page = TELEMETRY_PAGE_MEMORY;  // Page returned by the next GET_FEATURE
+static volatile uint8_t pending_command = TELEMETRY_CMD_NONE;
+
+// Handle GET_FEATURE for the telemetry report
+// The buffer excludes the report ID (TinyUSB prepends it). Returns the number of bytes written.
+uint16_t telemetry_get_report(uint8_t *buffer, uint16_t reqlen)
+{
+  if (reqlen < TELEMETRY_HEADER_SIZE) return 0;
+
+  uint16_t len = 0;
+  uint16_t room = reqlen - TELEMETRY_HEADER_SIZE;
+  if (room > TELEMETRY_PAGE_MAX) room = TELEMETRY_PAGE_MAX;
+
+  if (selected_page < TELEMETRY_PAGE_COUNT && _telemetry_pages[selected_page])
+  {
+    len = _telemetry_pages[selected_page](buffer + TELEMETRY_HEADER_SIZE, room);
+  }
+
+  buffer[0] = selected_page;
+  buffer[1] = (uint8_t) len;
+  return TELEMETRY_HEADER_SIZE + len;
+}
+
+// Handle SET_FEATURE for the telemetry report: the first payload byte selects the page, the
+// optional second byte queues a command for the main loop
+void telemetry_set_report(uint8_t const *buffer, uint16_t bufsize)
+{
+  if (bufsize < 1) return;
+  selected_page = buffer[0];
+
+  if (bufsize >= 2 && buffer[1] != TELEMETRY_CMD_NONE) pending_command = buffer[1];
+}
+
+// Returns and clears the pending command
+telemetry_command telemetry_take_command(void)
+{
+  telemetry_command cmd = (telemetry_command) pending_command;
+  pending_command = TELEMETRY_CMD_NONE;
+  return cmd;
+}
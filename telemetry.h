@@ -0,0 +1,78 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+//----------------------- Telemetry Feature Report -----------------------//
+// The telemetry feature report exposes internal counters to host-side tools. The report is too small
+// to carry everything at once, so it is split into pages: the host selects a page with SET_FEATURE
+// (first payload byte = page number) and then reads it back with GET_FEATURE.
+//
+// Every page reply starts with a two byte header { page, payload length } followed by the
+// little-endian, packed page payload. Unknown pages reply with a zero length payload.
+//
+// An optional second SET_FEATURE byte carries a command for the main loop (telemetry_command).
+#define TELEMETRY_REPORT_SIZE 63  // Payload bytes per feature report (64 byte EP0 packet minus report ID)
+#define TELEMETRY_HEADER_SIZE 2
+#define TELEMETRY_PAGE_MAX    (TELEMETRY_REPORT_SIZE - TELEMETRY_HEADER_SIZE)
+
+typedef enum
+{
+  TELEMETRY_PAGE_MEMORY = 0,  // Stack high-water marks (mem_budget.c)
+  TELEMETRY_PAGE_BOOT,        // Boot-to-mount and mount-to-first-report timings (boot_profile.c)
+  TELEMETRY_PAGE_SUPERVISOR,  // Reset reason and hang diagnostics of the previous run (supervisor.c)
+  TELEMETRY_PAGE_INPUT,       // Output quantizer state and suppressed updates per axis (pico_hid.c)
+  TELEMETRY_PAGE_DRIFT,       // Stick center estimates and rest detection (drift.c)
+  TELEMETRY_PAGE_TEMPCO,      // Chip temperature and stick temperature model (tempco.c)
+  TELEMETRY_PAGE_HEALTH,      // Stick wear statistics: range, spikes, noise (axis_health.c)
+  TELEMETRY_PAGE_TASKS,       // Periodic task deadline misses and lateness histograms (periodic.c)
+  TELEMETRY_PAGE_SAMPLER,     // Sampling scheduler tick, skipped ticks and longest tick (sampler.c)
+  TELEMETRY_PAGE_ACQUIRE,     // DMA acquisition ring positions and newest GPIO snapshot (acquire.c)
+  TELEMETRY_PAGE_CPU,         // CPU time spent on input acquisition and reports (cpu_load.c)
+  TELEMETRY_PAGE_MUX,         // Analog mux channel values (pico_hid.c)
+  TELEMETRY_PAGE_WHEEL,       // Wheel position and axes of the wheel personality (wheel.c)
+  TELEMETRY_PAGE_MIDI,        // Event counters and edge-to-note latency of the MIDI personality (midi.c)
+  TELEMETRY_PAGE_JVS,         // Address, frame counters and reply latency of the JVS personality (jvs.c)
+  TELEMETRY_PAGE_COUNT
+} telemetry_page;
+
+typedef enum
+{
+  TELEMETRY_CMD_NONE = 0,
+  TELEMETRY_CMD_REENUMERATE,  // Detach from the bus and reattach (simulated re-enumeration)
+  TELEMETRY_CMD_HEALTH_RESET, // Clear the stick health statistics
+} telemetry_command;
+
+// Page fill callback: writes at most `len` bytes into `buf` and returns the number of bytes written
+typedef uint16_t (*telemetry_page_fn)(uint8_t *buf, uint16_t len);
+
+uint16_t telemetry_get_report(uint8_t *buffer, uint16_t reqlen);
+void telemetry_set_report(uint8_t const *buffer, uint16_t bufsize);
+telemetry_command telemetry_take_command(void);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,173 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/sync.h"
+#include "flash_layout.h"
+#include "record_log.h"
+#include "drift.h"
+#include "tempco.h"
+
+// Persisted model
+typedef struct
+{
+  int16_t t_ref_q8;                    // Reference temperature, degC in 8.8
+  int16_t reserved;
+  int32_t k_q16[TEMPCO_AXIS_COUNT];    // Center shift per degC, 16.16 ADC codes
+} tempco_model;
+
+typedef struct
+{
+  int16_t t_q8;
+  int32_t mean_q16[TEMPCO_AXIS_COUNT];
+} tempco_point;
+
+static tempco_model model;
+static record_log tempco_log;
+
+static int32_t temp_q8;        // Filtered temperature, degC in 8.8
+static bool temp_valid;
+static int32_t offset_q16[TEMPCO_AXIS_COUNT];
+
+static tempco_point points[2];
+static uint8_t point_count;
+
+// RP2040 datasheet: T = 27 - (V - 0.706) / 0.001721, V = raw * 3.3 / 4096
+static int32_t raw_to_q8(uint16_t raw)
+{
+  int32_t const mv_q8 = ((int32_t) raw * 825) >> 2;  // raw * 3300 / 4096 mV, in 8.8
+  return 27 * 256 - (mv_q8 - 706 * 256) * 1000 / 1721;
+}
+
+static void update_offsets(void)
+{
+  for (int i = 0; i < TEMPCO_AXIS_COUNT; i++)
+  {
+    offset_q16[i] = (int32_t) (((int64_t) model.k_q16[i] * (temp_q8 - model.t_ref_q8)) >> 8);
+  }
+}
+
+void tempco_init(void)
+{
+  adc_set_temp_sensor_enabled(true);
+  if (!record_log_open(&tempco_log, FLASH_TEMPCO_LOG_OFFSET, RECORD_LOG_RECORD_SIZE, &model, sizeof(model)))
+  {
+    memset(&model, 0, sizeof(model));
+  }
+}
+
+// New reading of the sensor channel; the first one seeds the filter
+void tempco_sample(uint16_t raw)
+{
+  int32_t const t = raw_to_q8(raw);
+  temp_q8 = temp_valid ? temp_q8 + ((t - temp_q8) >> 3) : t;
+  temp_valid = true;
+  update_offsets();
+}
+
+int16_t tempco_temperature_q8(void)
+{
+  return (int16_t) temp_q8;
+}
+
+int32_t tempco_offset_q16(uint8_t axis)
+{
+  return offset_q16[axis];
+}
+
+//----------------------- Calibration -----------------------//
+// Keep the last two captures of the resting sticks
+void tempco_capture(void)
+{
+  points[0] = points[1];
+  points[1].t_q8 = (int16_t) temp_q8;
+  for (int i = 0; i < TEMPCO_AXIS_COUNT; i++) points[1].mean_q16[i] = drift_mean_q16(i);
+  if (point_count < 2) point_count++;
+}
+
+static void install(const tempco_model *next)
+{
+  int32_t before[TEMPCO_AXIS_COUNT], delta[TEMPCO_AXIS_COUNT];
+  memcpy(before, offset_q16, sizeof(before));
+
+  uint32_t const irq = save_and_disable_interrupts();  // tempco_sample() runs in the sampler interrupt
+  model = *next;
+  update_offsets();
+  restore_interrupts(irq);
+  record_log_append(&tempco_log, &model, sizeof(model));
+
+  for (int i = 0; i < TEMPCO_AXIS_COUNT; i++) delta[i] = before[i] - offset_q16[i];
+  drift_rebase(delta);
+}
+
+// Fit the model through the two captures
+bool tempco_commit(void)
+{
+  if (point_count < 2) return false;
+
+  int32_t const span = points[1].t_q8 - points[0].t_q8;
+  if (span < TEMPCO_MIN_SPAN_Q8 && span > -TEMPCO_MIN_SPAN_Q8) return false;
+
+  tempco_model next = { .t_ref_q8 = points[0].t_q8 };
+  for (int i = 0; i < TEMPCO_AXIS_COUNT; i++)
+  {
+    int64_t const k = ((int64_t) (points[1].mean_q16[i] - points[0].mean_q16[i]) << 8) / span;
+    if (k > TEMPCO_K_MAX_Q16 || k < -TEMPCO_K_MAX_Q16) return false;
+    next.k_q16[i] = (int32_t) k;
+  }
+
+  install(&next);
+  point_count = 0;
+  return true;
+}
+
+void tempco_clear(void)
+{
+  tempco_model const none = { 0 };
+  install(&none);
+  point_count = 0;
+}
+
+// Telemetry page: i16 temperature (8.8 degC), i16 t_ref (8.8 degC), then per axis
+// { i32 k_q16, i32 offset_q16 }, then u8 captured points
+uint16_t tempco_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 4 + TEMPCO_AXIS_COUNT * 8 + 1) return 0;
+
+  int16_t const t = (int16_t) temp_q8;
+  memcpy(&buf[0], &t, 2);
+  memcpy(&buf[2], &model.t_ref_q8, 2);
+  uint8_t *p = &buf[4];
+  for (int i = 0; i < TEMPCO_AXIS_COUNT; i++)
+  {
+    memcpy(p, &model.k_q16[i], 4);
+    memcpy(p + 4, &offset_q16[i], 4);
+    p += 8;
+  }
+  *p++ = point_count;
+  return (uint16_t) (p - buf);
+}
@@ -0,0 +1,59 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef TEMPCO_H_
+#define TEMPCO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//----------------------- Temperature Compensation -----------------------//
+// The stick tracks drift with temperature, and the cabinets warm up a lot over the day. The on-chip
+// sensor (ADC input 4) gets a slot of its own in the sampling scheduler at a low rate (pico_hid.c),
+// so the stick samples and the reports do not pay for it.
+//
+// Each axis has a linear model, learned during calibration: center shift = k * (T - T_ref). The
+// station captures the resting sticks at two temperatures (TEMPCO_POINT) and commits the fit
+// (TEMPCO_COMMIT); without a model the shift is zero.
+#define TEMPCO_AXIS_COUNT     2
+#define TEMPCO_ADC_INPUT      4
+#define TEMPCO_MIN_SPAN_Q8    (5 * 256)      // Calibration points must be at least 5 degC apart
+#define TEMPCO_K_MAX_Q16      (4 << 16)      // Fits above 4 codes/degC are rejected as bad captures
+
+void tempco_init(void);
+void tempco_sample(uint16_t raw);
+int16_t tempco_temperature_q8(void);
+
+// Center shift of an axis at the current temperature, 16.16 ADC codes (updated by tempco_sample)
+int32_t tempco_offset_q16(uint8_t axis);
+
+// Calibration (driven by calibration.c)
+void tempco_capture(void);
+bool tempco_commit(void);
+void tempco_clear(void);
+
+uint16_t tempco_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* TEMPCO_H_ */
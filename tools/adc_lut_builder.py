@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Build a per-unit ADC linearity correction table and optionally load it into a controller.
+
+The factory station feeds a slow, linear ramp (or a triangle wave) that covers the whole input range
+into one analog mux channel and records the raw codes the firmware reads, one decimal code per line;
+--capture switches the controller's correction off and records them through the telemetry MUX page.
+With a linear input every code should be hit equally often, so the code-density histogram gives the width of
+each code (DNL); the running sum gives the transfer curve (INL). Each code is then mapped to the
+centre of the input range that produces it, and the table stores that as a signed delta per code:
+
+    python3 tools/adc_lut_builder.py --capture 0 sweep.txt          # record a sweep on mux channel 0
+    python3 tools/adc_lut_builder.py sweep.txt -o lut.bin           # build and save
+    python3 tools/adc_lut_builder.py sweep.txt --upload             # build and store on the device
+    python3 tools/adc_lut_builder.py --clear                        # back to the errata model
+
+The device keeps the table in the settings flash area (see adc_correction.h and calibration.h).
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+import time
+
+USB_VID = 0xACE9
+USB_PID = 0x4004  # Gamepad personality; the others are USB_PID | n << 5 (usb_descriptors.c)
+USB_PID_PERSONALITY_MASK = 0x7 << 5
+
+REPORT_ID_TELEMETRY = 2
+TELEMETRY_REPORT_SIZE = 63
+TELEMETRY_PAGE_MUX = 11
+INPUT_MUX_COUNT = 16
+
+REPORT_ID_CALIBRATION = 4
+CAL_REPORT_SIZE = 63
+CAL_LUT_BLOCK_MAX = 56
+
+OP_LUT_BEGIN, OP_LUT_DATA, OP_LUT_COMMIT, OP_LUT_CLEAR = 1, 2, 3, 4
+OP_LUT_RAW = 12
+ERR_NAMES = ["none", "unknown op", "length", "sequence", "crc", "fit", "range"]
+SOURCE_NAMES = ["identity", "errata model", "factory table"]
+
+ADC_CODES = 4096
+MIN_HITS_PER_CODE = 16   # below this the histogram is too noisy to trust
+
+
+def controllers():
+    """hid.enumerate() entries of every controller, whichever personality it was powered up in."""
+    import hid
+    return [d for d in hid.enumerate(USB_VID) if (d["product_id"] & ~USB_PID_PERSONALITY_MASK) == USB_PID]
+
+
+def build_deltas(codes):
+    hist = [0] * ADC_CODES
+    for c in codes:
+        hist[c] += 1
+
+    # The end codes collect everything beyond the rails; ignore them and extend the nearest codes
+    inner = hist[1:-1]
+    total = sum(inner)
+    if total < MIN_HITS_PER_CODE * len(inner):
+        raise ValueError(f"{len(codes)} samples is not enough, need about {MIN_HITS_PER_CODE * ADC_CODES}")
+
+    scale = (ADC_CODES - 2) / total
+    widths = [1.0] + [h * scale for h in inner] + [1.0]
+
+    deltas = []
+    edge = 0.0
+    worst_dnl = max(abs(w - 1.0) for w in widths)
+    worst_inl = 0.0
+    for code, width in enumerate(widths):
+        centre = edge + width / 2 - 0.5
+        worst_inl = max(worst_inl, abs(centre - code))
+        deltas.append(max(-128, min(127, round(centre) - code)))
+        edge += width
+
+    return deltas, worst_dnl, worst_inl
+
+
+def read_sweep(path):
+    codes = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line and not line.startswith("#"):
+                code = int(line)
+                if not 0 <= code < ADC_CODES:
+                    raise ValueError(f"code {code} out of range")
+                codes.append(code)
+    return codes
+
+
+class Device:
+    def __init__(self, serial=None):
+        import hid
+        self.dev = hid.device()
+        found = [d for d in controllers() if serial is None or d["serial_number"] == serial]
+        if not found:
+            raise RuntimeError("controller %s not found" % (serial or ""))
+        self.dev.open_path(found[0]["path"])
+
+    def command(self, payload):
+        self.dev.send_feature_report(bytes([REPORT_ID_CALIBRATION]) + payload)
+        raw = bytes(self.dev.get_feature_report(REPORT_ID_CALIBRATION, CAL_REPORT_SIZE + 1))
+        if raw and raw[0] == REPORT_ID_CALIBRATION:
+            raw = raw[1:]
+        op, error, next_offset, source = struct.unpack_from("<BBHB", raw)
+        if error:
+            raise RuntimeError(f"op {op} failed: {ERR_NAMES[error] if error < len(ERR_NAMES) else error}")
+        return next_offset, source
+
+    def upload(self, deltas):
+        data = struct.pack(f"<{ADC_CODES}b", *deltas)
+        self.command(bytes([OP_LUT_BEGIN]))
+        for offset in range(0, ADC_CODES, CAL_LUT_BLOCK_MAX):
+            block = data[offset:offset + CAL_LUT_BLOCK_MAX]
+            self.command(struct.pack("<BHB", OP_LUT_DATA, offset, len(block)) + block)
+        _, source = self.command(struct.pack("<BI", OP_LUT_COMMIT, binascii.crc32(data)))
+        return source
+
+    def clear(self):
+        _, source = self.command(bytes([OP_LUT_CLEAR]))
+        return source
+
+    def capture(self, channel, count):
+        """Uncorrected codes of mux `channel`, read while the controller passes the ADC codes through."""
+        self.command(bytes([OP_LUT_RAW, 1]))
+        codes = []
+        try:
+            self.dev.send_feature_report(bytes([REPORT_ID_TELEMETRY, TELEMETRY_PAGE_MUX]) +
+                                         bytes(TELEMETRY_REPORT_SIZE - 1))
+            while len(codes) < count:
+                data = bytes(self.dev.get_feature_report(REPORT_ID_TELEMETRY, TELEMETRY_REPORT_SIZE + 1))
+                if data[1] != TELEMETRY_PAGE_MUX or data[2] < 2 * INPUT_MUX_COUNT:
+                    raise RuntimeError("unexpected telemetry reply")
+                codes.append(struct.unpack_from("<H", data, 3 + 2 * channel)[0])
+                if len(codes) % 4096 == 0:
+                    print(f"\r{len(codes)} of {count} samples", end="", flush=True)
+            print()
+        finally:
+            self.command(bytes([OP_LUT_RAW, 0]))
+        return codes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sweep", nargs="?", help="raw codes from a linear sweep, one per line")
+    parser.add_argument("--capture", type=int, metavar="CHANNEL",
+                        help="record the sweep from this mux channel (into the sweep file, if given)")
+    parser.add_argument("--samples", type=int, default=MIN_HITS_PER_CODE * ADC_CODES * 2,
+                        help="samples to record with --capture")
+    parser.add_argument("-o", "--output", help="write the int8 delta table to this file")
+    parser.add_argument("--upload", action="store_true", help="store the table on the controller")
+    parser.add_argument("--clear", action="store_true", help="remove the stored table")
+    parser.add_argument("--serial", help="controller serial number (default: first found)")
+    args = parser.parse_args()
+
+    if args.clear:
+        start = time.monotonic()
+        source = Device(args.serial).clear()
+        print(f"cleared in {time.monotonic() - start:.2f} s, now using the {SOURCE_NAMES[source]}")
+        return 0
+
+    if args.capture is not None:
+        if not 0 <= args.capture < INPUT_MUX_COUNT:
+            parser.error(f"--capture takes a mux channel 0..{INPUT_MUX_COUNT - 1}")
+        codes = Device(args.serial).capture(args.capture, args.samples)
+        if args.sweep:
+            with open(args.sweep, "w") as f:
+                f.write("".join(f"{c}\n" for c in codes))
+    elif args.sweep:
+        codes = read_sweep(args.sweep)
+    else:
+        parser.error("a sweep file or --capture is required unless --clear is given")
+
+    deltas, dnl, inl = build_deltas(codes)
+    print(f"worst DNL {dnl:.2f} LSB, worst INL {inl:.2f} LSB, largest correction {max(map(abs, deltas))} LSB")
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(struct.pack(f"<{ADC_CODES}b", *deltas))
+
+    if args.upload:
+        source = Device(args.serial).upload(deltas)
+        print(f"stored, controller now using the {SOURCE_NAMES[source]}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Rank the buttons of every connected controller by remaining microswitch life.
+
+Reads the button stats feature report (see button_stats.h) of each controller and lists all buttons
+of the fleet, most worn first, with their press count, the share of their rated life left and how
+their presses split between taps and holds:
+
+    python3 tools/button_wear.py --rated-life 10000000
+    python3 tools/button_wear.py --top 20 --csv wear.csv
+    python3 tools/button_wear.py --reset SERIAL:BUTTON     # after replacing a switch
+
+Needs the `hid` package (hidapi).
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+import hid
+
+USB_VID = 0xACE9
+USB_PID = 0x4004  # Gamepad personality; the others are USB_PID | n << 5 (usb_descriptors.c)
+USB_PID_PERSONALITY_MASK = 0x7 << 5
+
+REPORT_ID_BUTTON_STATS = 5
+BUTTON_STATS_REPORT_SIZE = 63
+BUTTON_STATS_CMD_RESET = 1
+
+# Physical buttons in _button_config order (pico_hid.c)
+BUTTON_NAMES = ["South", "East", "North", "West", "Mode", "Select", "Start"]
+BUCKET_LABELS = ["<16ms", "<64ms", "<256ms", "<1s", "<4s", ">=4s"]
+
+
+def controllers():
+    """hid.enumerate() entries of every controller, whichever personality it was powered up in."""
+    return [d for d in hid.enumerate(USB_VID) if (d["product_id"] & ~USB_PID_PERSONALITY_MASK) == USB_PID]
+
+
+def select(dev, first, command=0):
+    dev.send_feature_report(bytes([REPORT_ID_BUTTON_STATS, first, command]) +
+                            bytes(BUTTON_STATS_REPORT_SIZE - 2))
+
+
+def read_buttons(dev):
+    buttons = []
+    first = 0
+    while True:
+        select(dev, first)
+        data = bytes(dev.get_feature_report(REPORT_ID_BUTTON_STATS, BUTTON_STATS_REPORT_SIZE + 1))
+        reply_first, n, count, buckets = data[1:5]
+        if reply_first != first:
+            raise RuntimeError("unexpected button stats reply")
+        offset = 5
+        for i in range(n):
+            fields = struct.unpack_from("<I%dI" % buckets, data, offset)
+            offset += 4 * (1 + buckets)
+            index = first + i
+            buttons.append({
+                "button": BUTTON_NAMES[index] if index < len(BUTTON_NAMES) else "button%d" % index,
+                "index": index,
+                "presses": fields[0],
+                "histogram": list(fields[1:]),
+            })
+        first += n
+        if n == 0 or first >= count:
+            return buttons
+
+
+def open_serial(serial):
+    for info in controllers():
+        if info["serial_number"] == serial:
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev
+    raise RuntimeError("controller %s not found" % serial)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--rated-life", type=int, default=10_000_000, help="rated actuations per switch")
+    parser.add_argument("--top", type=int, default=0, help="only list the N most worn buttons")
+    parser.add_argument("--csv", help="append the readings to this CSV file")
+    parser.add_argument("--reset", metavar="SERIAL:BUTTON", help="clear the counters of one button")
+    args = parser.parse_args()
+
+    if args.reset:
+        serial, button = args.reset.rsplit(":", 1)
+        index = BUTTON_NAMES.index(button) if button in BUTTON_NAMES else int(button)
+        dev = open_serial(serial)
+        select(dev, index, BUTTON_STATS_CMD_RESET)
+        dev.close()
+        print("cleared %s button %s" % (serial, button))
+        return 0
+
+    rows = []
+    for info in controllers():
+        dev = hid.device()
+        dev.open_path(info["path"])
+        try:
+            for button in read_buttons(dev):
+                button["serial"] = info["serial_number"]
+                button["life_left"] = max(0.0, 1.0 - button["presses"] / args.rated_life)
+                rows.append(button)
+        finally:
+            dev.close()
+
+    if not rows:
+        print("no controllers found")
+        return 1
+
+    rows.sort(key=lambda b: b["life_left"])
+    for b in rows[:args.top or len(rows)]:
+        releases = sum(b["histogram"]) or 1
+        split = " ".join("%s %2.0f%%" % (label, 100 * n / releases)
+                         for label, n in zip(BUCKET_LABELS, b["histogram"]))
+        print("%-16s %-7s %10d presses  %5.1f%% life left  %s" %
+              (b["serial"], b["button"], b["presses"], 100 * b["life_left"], split))
+
+    if args.csv:
+        now = int(time.time())
+        with open(args.csv, "a", newline="") as f:
+            writer = csv.writer(f)
+            for b in rows:
+                writer.writerow([now, b["serial"], b["button"], b["presses"]] + b["histogram"])
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
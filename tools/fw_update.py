@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+"""Push a firmware update to one or many controllers over the HID firmware update feature report.
+
+Each controller runs from slot A or B (see flash_layout.h) and is updated in the other slot, so the
+updater needs the image linked for each slot:
+
+    python3 tools/fw_update.py --slot-a build/pico_hid_slot_a.bin --slot-b build/pico_hid_slot_b.bin
+
+All connected controllers (or the ones given with --serial) are updated in parallel. The sequence per
+device is BEGIN -> wait for erase -> stream DATA blocks -> FINISH -> wait for verify -> ACTIVATE ->
+wait for the device to come back from the new slot and confirm its trial boot.
+
+--simulate N runs the same code against N in-process simulated devices (with --fault-rate of the
+blocks corrupted in transit), which exercises resume and verify without hardware or hidapi.
+"""
+
+import argparse
+import binascii
+import concurrent.futures
+import random
+import struct
+import sys
+import threading
+import time
+
+USB_VID = 0xACE9
+USB_PID = 0x4004  # Gamepad personality; the others are USB_PID | n << 5 (usb_descriptors.c)
+USB_PID_PERSONALITY_MASK = 0x7 << 5
+
+REPORT_ID_FW_UPDATE = 3
+FW_UPDATE_REPORT_SIZE = 63
+
+OP_BEGIN, OP_DATA, OP_FINISH, OP_ACTIVATE, OP_ABORT = 1, 2, 3, 4, 5
+(STATE_IDLE, STATE_ERASING, STATE_RECEIVING, STATE_VERIFYING, STATE_VERIFIED, STATE_ACTIVATING,
+ STATE_FAILED) = range(7)
+ERR_NONE, ERR_NOT_SLOTTED, ERR_TOO_LARGE, ERR_BAD_STATE, ERR_SEQUENCE, ERR_BLOCK_CRC, ERR_IMAGE_CRC = range(7)
+
+SLOT_SIZE = 0x0F0000
+STATUS_EVERY = 64        # DATA blocks sent between status checks
+CONFIRM_TIMEOUT_S = 15.0
+
+
+def controllers():
+    """hid.enumerate() entries of every controller, whichever personality it was powered up in."""
+    import hid
+    return [d for d in hid.enumerate(USB_VID) if (d["product_id"] & ~USB_PID_PERSONALITY_MASK) == USB_PID]
+
+
+class Status:
+    def __init__(self, raw):
+        (self.state, self.error, self.next_offset, self.running_slot, self.target_slot, self.trial,
+         self.attempts, self.block_max) = struct.unpack_from("<BBIBBBBB", raw)
+
+
+def data_block(offset, chunk):
+    return struct.pack("<BIBI", OP_DATA, offset, len(chunk), binascii.crc32(chunk)) + chunk
+
+
+#----------------------- Transports -----------------------#
+
+class HidDevice:
+    """A real controller, found again by serial number after every reboot."""
+
+    def __init__(self, serial):
+        self.serial = serial
+        self.dev = None
+
+    def open(self, timeout_s=10.0):
+        import hid
+        deadline = time.monotonic() + timeout_s
+        while time.monotonic() < deadline:
+            for info in controllers():
+                if info.get("serial_number") == self.serial:
+                    self.dev = hid.device()
+                    self.dev.open_path(info["path"])
+                    return
+            time.sleep(0.05)
+        raise RuntimeError("%s did not come back" % self.serial)
+
+    def close(self):
+        if self.dev:
+            self.dev.close()
+            self.dev = None
+
+    def command(self, payload):
+        payload = payload + bytes(FW_UPDATE_REPORT_SIZE - len(payload))
+        self.dev.send_feature_report(bytes([REPORT_ID_FW_UPDATE]) + payload)
+
+    def status(self):
+        raw = bytes(self.dev.get_feature_report(REPORT_ID_FW_UPDATE, FW_UPDATE_REPORT_SIZE + 1))
+        return Status(raw[1:])
+
+
+class SimulatedDevice:
+    """In-process model of fw_update.c plus the bootloader's trial/confirm behaviour."""
+
+    def __init__(self, serial, fault_rate=0.0, seed=None):
+        self.serial = serial
+        self.fault_rate = fault_rate
+        self.rng = random.Random(seed)
+        self.slots = [bytearray(b"\xff" * SLOT_SIZE), bytearray(b"\xff" * SLOT_SIZE)]
+        self.running = self.rng.randrange(2)
+        self.trial = 0
+        self.attempts = 0
+        self.state = STATE_IDLE
+        self.error = ERR_NONE
+        self.next_offset = 0
+        self.size = self.crc = 0
+        self.busy_polls = 0
+        self.lock = threading.Lock()
+
+    def open(self, timeout_s=10.0):
+        pass
+
+    def close(self):
+        pass
+
+    def command(self, payload):
+        with self.lock:
+            op = payload[0]
+            if op == OP_DATA and self.rng.random() < self.fault_rate:
+                payload = payload[:-1] + bytes([payload[-1] ^ 0xFF])  # corrupted on the wire
+            if op == OP_BEGIN:
+                self.size, self.crc = struct.unpack_from("<II", payload, 1)
+                if self.size == 0 or self.size > SLOT_SIZE:
+                    self.error = ERR_TOO_LARGE
+                    return
+                self.state, self.error, self.next_offset = STATE_ERASING, ERR_NONE, 0
+                self.busy_polls = 1 + self.size // 4096
+                self.slots[self.running ^ 1][:self.size] = b"\xff" * self.size
+            elif op == OP_DATA:
+                offset, n, crc = struct.unpack_from("<IBI", payload, 1)
+                chunk = payload[10:10 + n]
+                if self.state != STATE_RECEIVING:
+                    self.error = ERR_BAD_STATE
+                elif offset != self.next_offset or offset + n > self.size:
+                    self.error = ERR_SEQUENCE
+                elif binascii.crc32(chunk) != crc:
+                    self.error = ERR_BLOCK_CRC
+                else:
+                    self.slots[self.running ^ 1][offset:offset + n] = chunk
+                    self.next_offset += n
+                    self.error = ERR_NONE
+            elif op == OP_FINISH:
+                if self.state != STATE_RECEIVING or self.next_offset != self.size:
+                    self.error = ERR_BAD_STATE
+                    return
+                self.state, self.busy_polls = STATE_VERIFYING, 1 + self.size // 4096
+            elif op == OP_ACTIVATE:
+                if self.state != STATE_VERIFIED:
+                    self.error = ERR_BAD_STATE
+                    return
+                # Reboot into the new slot on trial; the bootloader's first-attempt CRC check
+                image = bytes(self.slots[self.running ^ 1][:self.size])
+                if binascii.crc32(image) == self.crc:
+                    self.running ^= 1
+                    self.trial, self.attempts = 1, 1
+                self.state, self.error = STATE_IDLE, ERR_NONE
+                self.busy_polls = 3  # polls until the trial boot confirms itself
+            elif op == OP_ABORT:
+                self.state, self.error = STATE_IDLE, ERR_NONE
+
+    def status(self):
+        with self.lock:
+            if self.busy_polls:
+                self.busy_polls -= 1
+            elif self.state == STATE_ERASING:
+                self.state = STATE_RECEIVING
+            elif self.state == STATE_VERIFYING:
+                image = bytes(self.slots[self.running ^ 1][:self.size])
+                ok = binascii.crc32(image) == self.crc
+                self.state = STATE_VERIFIED if ok else STATE_FAILED
+                self.error = ERR_NONE if ok else ERR_IMAGE_CRC
+            elif self.trial:
+                self.trial, self.attempts = 0, 0
+            raw = struct.pack("<BBIBBBBB", self.state, self.error, self.next_offset, self.running,
+                              self.running ^ 1, self.trial, self.attempts, 52)
+            return Status(raw)
+
+
+#----------------------- Update sequence -----------------------#
+
+def wait_state(dev, states, timeout_s=30.0, errors=()):
+    """Polls until the device is in one of `states`; any error in `errors` fails at once."""
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        st = dev.status()
+        if st.state in states:
+            return st
+        if st.error in errors:
+            raise RuntimeError("device rejected the update (error %d)" % st.error)
+        time.sleep(0.005)
+    raise RuntimeError("timed out waiting for state %s" % (states,))
+
+
+def update_device(dev, images, log):
+    start = time.monotonic()
+    dev.open()
+    st = dev.status()
+    if st.running_slot > 1:
+        raise RuntimeError("device runs without the bootloader, flash pico_hid_boot.uf2 first")
+
+    target = st.target_slot
+    image = images[target]
+    crc = binascii.crc32(image)
+    log("running slot %s, writing %d bytes to slot %s" % ("AB"[st.running_slot], len(image), "AB"[target]))
+
+    dev.command(struct.pack("<BII", OP_BEGIN, len(image), crc))
+    # A rejected BEGIN leaves the device idle with the error set; there is nothing to wait for
+    st = wait_state(dev, (STATE_RECEIVING, STATE_FAILED), errors=(ERR_NOT_SLOTTED, ERR_TOO_LARGE, ERR_BAD_STATE))
+    block = st.block_max
+
+    offset, sent, resends = 0, 0, 0
+    while True:
+        while offset < len(image):
+            dev.command(data_block(offset, image[offset:offset + block]))
+            offset += block
+            sent += 1
+            if sent % STATUS_EVERY == 0:
+                break
+        st = dev.status()
+        if st.next_offset != min(offset, len(image)):
+            resends += 1
+            offset = st.next_offset  # A block was dropped; everything after it was rejected
+        elif offset >= len(image):
+            break
+
+    dev.command(bytes([OP_FINISH]))
+    st = wait_state(dev, (STATE_VERIFIED, STATE_FAILED))
+    if st.state != STATE_VERIFIED:
+        raise RuntimeError("image verification failed (error %d)" % st.error)
+
+    stream_s = time.monotonic() - start
+    dev.command(bytes([OP_ACTIVATE]))
+    dev.close()
+    time.sleep(0.2)
+
+    deadline = time.monotonic() + CONFIRM_TIMEOUT_S
+    dev.open()
+    while True:
+        st = dev.status()
+        if st.running_slot != target:
+            raise RuntimeError("device rolled back to slot %s" % "AB"[st.running_slot])
+        if not st.trial:
+            break
+        if time.monotonic() > deadline:
+            raise RuntimeError("trial boot was not confirmed")
+        time.sleep(0.1)
+    dev.close()
+
+    log("done: %.1f kB/s, %d resumes, confirmed in slot %s" %
+        (len(image) / 1024.0 / stream_s, resends, "AB"[target]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--slot-a", required=True, help="image linked for slot A (pico_hid_slot_a.bin)")
+    parser.add_argument("--slot-b", required=True, help="image linked for slot B (pico_hid_slot_b.bin)")
+    parser.add_argument("--serial", action="append", help="only update these controllers")
+    parser.add_argument("--simulate", type=int, metavar="N", help="update N simulated devices instead")
+    parser.add_argument("--fault-rate", type=float, default=0.0, help="simulated block corruption rate")
+    args = parser.parse_args()
+
+    images = []
+    for path in (args.slot_a, args.slot_b):
+        with open(path, "rb") as f:
+            images.append(f.read())
+
+    if args.simulate:
+        devices = [SimulatedDevice("SIM%04d" % i, args.fault_rate, seed=i) for i in range(args.simulate)]
+    else:
+        serials = args.serial or sorted({d["serial_number"] for d in controllers()})
+        devices = [HidDevice(s) for s in serials]
+    if not devices:
+        print("no controllers found", file=sys.stderr)
+        return 1
+
+    print_lock = threading.Lock()
+
+    def run(dev):
+        def log(msg):
+            with print_lock:
+                print("[%s] %s" % (dev.serial, msg))
+        try:
+            update_device(dev, images, log)
+            return True
+        except Exception as e:  # one bad unit must not stop the rest of the fleet
+            log("FAILED: %s" % e)
+            return False
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=len(devices)) as pool:
+        results = list(pool.map(run, devices))
+
+    print("%d of %d controllers updated" % (sum(results), len(results)))
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,354 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+//----------------------- JVS Master Simulator -----------------------//
+// Plays the game PCB's side of JVS against an I/O board and checks every reply: reset, address
+// assignment, identification, the feature check, switch/coin/analog reads, coin commands,
+// retransmission and the error statuses. The latency of each reply is measured, from the end of the
+// request to the first byte of the reply. With a real board, replies later than the deadline count as
+// failures. Over the pseudo-terminal the latency is the host's scheduling, so it is only shown.
+//
+//   cc -O2 -I. -o jvs_sim tools/jvs_sim.c jvs_protocol.c -lutil
+//   ./jvs_sim [--port /dev/ttyUSB0] [--cycles 1000] [--deadline 1000]
+//
+// Without --port the board is the firmware's protocol code (jvs_protocol.c, built from the same
+// source). It runs in a child process on the other end of a pseudo-terminal. Its inputs are
+// simulated, with three coins inserted at start. With --port the master talks to a real controller
+// in the JVS personality through a USB RS-485 adapter at 115200 baud. That controller's coin count
+// starts at whatever was inserted, so the coin checks only look at the changes.
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "jvs_protocol.h"
+
+#define NO_REPLY_WAIT_US  20000   // Silence that counts as "no reply"
+#define REPLY_WAIT_US     100000  // Give up on an expected reply
+#define SIM_COINS         3
+
+static uint32_t deadline_us = 1000;  // JVS_REPLY_DEADLINE_US (jvs.h)
+
+static uint64_t now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000u + (uint64_t) ts.tv_nsec / 1000u;
+}
+
+static int set_raw(int fd, bool serial)
+{
+  struct termios t;
+  if (tcgetattr(fd, &t) < 0) return -1;
+  cfmakeraw(&t);
+  if (serial)
+  {
+    cfsetispeed(&t, B115200);
+    cfsetospeed(&t, B115200);
+    t.c_cflag |= CLOCAL | CREAD;
+    t.c_cflag &= (tcflag_t) ~(CSTOPB | PARENB | CRTSCTS);
+  }
+  t.c_cc[VMIN] = 1;
+  t.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &t);
+}
+
+//----------------------- Simulated Board -----------------------//
+// Feeds every byte to the firmware parser and writes the reply, as the poll in jvs.c does
+static void run_board(int fd)
+{
+  jvs_inputs inputs = { .coin_presses = { SIM_COINS } };
+  uint32_t replies = 0;
+  uint8_t buf[256];
+
+  jvs_protocol_reset();
+  for (;;)
+  {
+    ssize_t const n = read(fd, buf, sizeof(buf));
+    if (n <= 0) _exit(0);
+    for (ssize_t i = 0; i < n; i++)
+    {
+      if (jvs_receive(buf[i]) == JVS_FRAME_NONE) continue;
+
+      // Inputs move between replies so the reads are not all the same
+      inputs.player[0][0] = (replies & 1) ? JVS_SW_START | JVS_SW_PUSH1 : JVS_SW_LEFT;
+      inputs.analog[0] = (uint16_t) (replies * 16u);
+      inputs.analog[1] = (uint16_t) (0xFFF0u - replies * 16u);
+
+      const uint8_t *frame;
+      uint16_t const len = jvs_reply(&inputs, &frame);
+      if (len && write(fd, frame, len) != len) _exit(1);
+      replies++;
+    }
+  }
+}
+
+//----------------------- Master -----------------------//
+static int bus = -1;
+static int failures;
+static uint64_t latency_sum_us;
+static uint32_t latency_max_us, latency_count, late;
+
+static void check(bool ok, const char *what)
+{
+  printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+static void send_raw(const uint8_t *wire, uint16_t len)
+{
+  tcflush(bus, TCIFLUSH);
+  if (write(bus, wire, len) != len) { perror("write"); exit(1); }
+  tcdrain(bus);
+}
+
+static void send_frame(uint8_t node, const uint8_t *data, uint16_t len)
+{
+  uint8_t wire[JVS_WIRE_MAX];
+  send_raw(wire, jvs_encode(node, data, len, wire));
+}
+
+static int read_byte(uint64_t until_us)
+{
+  uint8_t b;
+  for (;;)
+  {
+    uint64_t const now = now_us();
+    if (now >= until_us) return -1;
+    struct pollfd p = { .fd = bus, .events = POLLIN };
+    int const r = poll(&p, 1, (int) ((until_us - now + 999) / 1000));
+    if (r < 0 && errno != EINTR) return -1;
+    if (r > 0 && read(bus, &b, 1) == 1) return b;
+  }
+}
+
+// Reads one reply frame into `data` (without the checksum) and returns its length, -1 for no reply,
+// -2 for a corrupt one. The time from the request to the first byte counts as the reply latency.
+static int read_frame(uint8_t *data, uint32_t wait_us)
+{
+  uint64_t const sent = now_us();
+  int b = read_byte(sent + wait_us);
+  if (b < 0) return -1;
+
+  uint32_t const latency = (uint32_t) (now_us() - sent);
+  latency_sum_us += latency;
+  latency_count++;
+  if (latency > latency_max_us) latency_max_us = latency;
+  if (latency > deadline_us) late++;
+
+  uint8_t raw[3 + JVS_DATA_MAX];
+  int n = 0, length = -1;
+  bool escape = false;
+  while (b >= 0 && b != JVS_SYNC) b = read_byte(sent + REPLY_WAIT_US);
+  for (;;)
+  {
+    b = read_byte(sent + REPLY_WAIT_US);
+    if (b < 0 || b == JVS_SYNC) return -2;
+    if (b == JVS_MARK) { escape = true; continue; }
+    raw[n++] = (uint8_t) (escape ? b + 1 : b);
+    escape = false;
+    if (n == 2) length = raw[1];
+    if (length >= 0 && n == length + 2) break;
+  }
+
+  uint8_t sum = 0;
+  for (int i = 0; i < n - 1; i++) sum += raw[i];
+  if (raw[0] != JVS_NODE_MASTER || length < 1 || sum != raw[n - 1]) return -2;
+  memcpy(data, &raw[2], (size_t) (length - 1));
+  return length - 1;
+}
+
+static int transact(uint8_t node, const uint8_t *request, uint16_t len, uint8_t *reply)
+{
+  send_frame(node, request, len);
+  return read_frame(reply, REPLY_WAIT_US);
+}
+
+static uint16_t coin_count(uint8_t node)
+{
+  uint8_t reply[JVS_DATA_MAX];
+  uint8_t const request[] = { JVS_CMD_COINS, 1 };
+  int const n = transact(node, request, sizeof(request), reply);
+  return n == 4 && reply[0] == JVS_STATUS_NORMAL ? (uint16_t) ((reply[2] << 8 | reply[3]) & JVS_COIN_MAX) : 0xFFFF;
+}
+
+static void run_master(unsigned cycles, bool simulated)
+{
+  uint8_t reply[JVS_DATA_MAX];
+  uint8_t const node = 1;
+  int n;
+
+  // Bring-up, as a game PCB does it: reset twice, then address the board
+  uint8_t const reset[] = { JVS_CMD_RESET, JVS_RESET_ARG };
+  send_frame(JVS_NODE_BROADCAST, reset, sizeof(reset));
+  send_frame(JVS_NODE_BROADCAST, reset, sizeof(reset));
+  check(read_frame(reply, NO_REPLY_WAIT_US) == -1, "reset: no reply");
+
+  uint8_t const id[] = { JVS_CMD_ID };
+  check(transact(node, id, sizeof(id), reply) == -1, "unaddressed board ignores node 1");
+
+  uint8_t const other[] = { JVS_STATUS_NORMAL, JVS_REPORT_NORMAL };
+  send_frame(JVS_NODE_MASTER, other, sizeof(other));
+  check(read_frame(reply, NO_REPLY_WAIT_US) == -1, "another board's reply is ignored");
+
+  uint8_t const set_address[] = { JVS_CMD_SET_ADDRESS, node };
+  n = transact(JVS_NODE_BROADCAST, set_address, sizeof(set_address), reply);
+  check(n == 2 && reply[0] == JVS_STATUS_NORMAL && reply[1] == JVS_REPORT_NORMAL, "set address 1");
+
+  uint8_t const set_next[] = { JVS_CMD_SET_ADDRESS, node + 1 };
+  check(transact(JVS_NODE_BROADCAST, set_next, sizeof(set_next), reply) == -1, "addressed board ignores address 2");
+
+  // Identification and versions
+  n = transact(node, id, sizeof(id), reply);
+  check(n > 3 && reply[0] == JVS_STATUS_NORMAL && reply[1] == JVS_REPORT_NORMAL && reply[n - 1] == 0, "identification");
+  if (n > 3) printf("  id: %s\n", (const char *) &reply[2]);
+
+  uint8_t const versions[] = { JVS_CMD_CMD_REVISION, JVS_CMD_JVS_REVISION, JVS_CMD_COMM_VERSION };
+  n = transact(node, versions, sizeof(versions), reply);
+  check(n == 7 && reply[0] == JVS_STATUS_NORMAL && reply[2] == 0x13 && reply[4] == 0x30 && reply[6] == 0x10,
+        "command, JVS and communication versions");
+
+  uint8_t const features[] = { JVS_CMD_FEATURES };
+  n = transact(node, features, sizeof(features), reply);
+  check(n >= 3 && reply[0] == JVS_STATUS_NORMAL && reply[n - 1] == 0x00 && (n - 3) % 4 == 0, "feature check");
+  for (int i = 2; i + 4 <= n; i += 4)
+  {
+    printf("  function %02x: %u %u %u\n", reply[i], reply[i + 1], reply[i + 2], reply[i + 3]);
+  }
+
+  uint8_t const main_id[] = { JVS_CMD_MAIN_ID, 'S', 'I', 'M', 0 };
+  n = transact(node, main_id, sizeof(main_id), reply);
+  check(n == 2 && reply[1] == JVS_REPORT_NORMAL, "main board id");
+
+  // Coins: the counter follows decrease and increase commands
+  uint16_t const coins = coin_count(node);
+  check(coins != 0xFFFF && (!simulated || coins == SIM_COINS), "coin read");
+  uint8_t const decrease[] = { JVS_CMD_COIN_DECREASE, 1, 0, 1 };
+  n = transact(node, decrease, sizeof(decrease), reply);
+  check(n == 2 && reply[1] == JVS_REPORT_NORMAL && coin_count(node) == (coins ? coins - 1 : 0), "coin decrease");
+  uint8_t const increase[] = { JVS_CMD_COIN_INCREASE, 1, 0, 5 };
+  n = transact(node, increase, sizeof(increase), reply);
+  check(n == 2 && reply[1] == JVS_REPORT_NORMAL && coin_count(node) == (coins ? coins - 1 : 0) + 5, "coin increase");
+
+  // Error handling
+  uint8_t const unknown[] = { JVS_CMD_CMD_REVISION, 0x7F };
+  n = transact(node, unknown, sizeof(unknown), reply);
+  check(n >= 1 && reply[0] == JVS_STATUS_UNKNOWN, "unknown command");
+
+  uint8_t wire[JVS_WIRE_MAX];
+  uint16_t const len = jvs_encode(node, id, sizeof(id), wire);
+  wire[len - 1] ^= 0x01;  // Checksum is never escaped for this frame
+  send_raw(wire, len);
+  n = read_frame(reply, REPLY_WAIT_US);
+  check(n == 1 && reply[0] == JVS_STATUS_CHECKSUM, "checksum error");
+
+  uint8_t first[JVS_DATA_MAX], again[JVS_DATA_MAX];
+  int const first_len = transact(node, id, sizeof(id), first);
+  uint8_t const retransmit[] = { JVS_CMD_RETRANSMIT };
+  int const again_len = transact(node, retransmit, sizeof(retransmit), again);
+  check(first_len > 0 && first_len == again_len && !memcmp(first, again, (size_t) first_len), "retransmit");
+
+  // The game loop: switches, coins and analog in one frame per cycle
+  latency_sum_us = latency_max_us = latency_count = late = 0;
+  uint8_t const inputs[] = { JVS_CMD_SWITCHES, 2, 2, JVS_CMD_COINS, 2, JVS_CMD_ANALOG, 4 };
+  unsigned good = 0;
+  for (unsigned i = 0; i < cycles; i++)
+  {
+    n = transact(node, inputs, sizeof(inputs), reply);
+    // status, (report, system, 2 x 2 switch bytes), (report, 2 x 2 coin bytes), (report, 4 x 2 analog bytes)
+    if (n == 1 + 6 + 5 + 9 && reply[0] == JVS_STATUS_NORMAL && reply[1] == JVS_REPORT_NORMAL &&
+        reply[7] == JVS_REPORT_NORMAL && reply[12] == JVS_REPORT_NORMAL) good++;
+  }
+  printf("%-48s %u/%u\n", "input cycles", good, cycles);
+  if (good != cycles) failures++;
+  if (latency_count)
+  {
+    printf("reply latency: avg %llu us, max %u us, %u of %u over %u us\n",
+           (unsigned long long) (latency_sum_us / latency_count), latency_max_us, late, latency_count, deadline_us);
+  }
+  if (late && !simulated) failures++;
+}
+
+int main(int argc, char **argv)
+{
+  const char *port = NULL;
+  unsigned long cycles = 1000;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    if (i + 1 >= argc) { fprintf(stderr, "%s needs a value\n", arg); return 2; }
+    const char *value = argv[++i];
+    if      (!strcmp(arg, "--port"))     port = value;
+    else if (!strcmp(arg, "--cycles"))   cycles = strtoul(value, NULL, 0);
+    else if (!strcmp(arg, "--deadline")) deadline_us = (uint32_t) strtoul(value, NULL, 0);
+    else
+    {
+      fprintf(stderr, "usage: %s [--port /dev/ttyUSB0] [--cycles N] [--deadline us]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  pid_t board = -1;
+  if (port)
+  {
+    bus = open(port, O_RDWR | O_NOCTTY);
+    if (bus < 0 || set_raw(bus, true) < 0) { perror(port); return 1; }
+  }
+  else
+  {
+    int master_fd, board_fd;
+    if (openpty(&master_fd, &board_fd, NULL, NULL, NULL) < 0) { perror("openpty"); return 1; }
+    set_raw(master_fd, false);
+    set_raw(board_fd, false);
+    board = fork();
+    if (board == 0)
+    {
+      close(master_fd);
+      run_board(board_fd);
+    }
+    close(board_fd);
+    bus = master_fd;
+  }
+
+  run_master((unsigned) cycles, !port);
+
+  if (board > 0)
+  {
+    kill(board, SIGTERM);
+    waitpid(board, NULL, 0);
+  }
+  printf("%s\n", failures ? "FAILED" : "passed");
+  return failures ? 1 : 0;
+}
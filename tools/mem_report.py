@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Attribute flash and RAM usage of the firmware image to source modules.
+
+Reads the GNU ld map file written next to the .elf (pico_add_extra_outputs adds -Map) and sums the
+input sections of every object file into:
+
+  text     code and read-only data executed/read from flash (XIP)
+  ramtext  code copied to SRAM at boot (__not_in_flash_func / .time_critical.*)
+  data     initialised RAM (costs flash for the load image as well)
+  bss      zero-initialised RAM
+
+Project sources are reported per file; SDK and TinyUSB objects are grouped by library directory.
+
+    python3 tools/mem_report.py build/pico_hid.elf.map [--ram-limit 270336] [-o report.txt]
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+# Input section line, either on one line or with the name wrapped onto the previous line
+SECTION_RE = re.compile(r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+NAME_ONLY_RE = re.compile(r"^ (\.\S+|COMMON)\s*$")
+ADDR_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+CATEGORIES = ("text", "ramtext", "data", "bss")
+
+SRAM_SIZE = 264 * 1024
+
+
+def classify(section):
+    if section.startswith((".time_critical", ".ram_func")):
+        return "ramtext"
+    if section.startswith((".bss", ".sbss", "COMMON", ".uninitialized_data", ".heap", ".stack")):
+        return "bss"
+    if section.startswith((".data", ".sdata", ".scratch_x", ".scratch_y")):
+        return "data"
+    if section.startswith((".text", ".rodata", ".boot2", ".vectors", ".init", ".fini", ".ARM",
+                           ".binary_info", ".embedded_block", ".flashdata")):
+        return "text"
+    return None
+
+
+def module_of(path):
+    path = path.strip()
+    # Archive members look like "libfoo.a(bar.o)"; report them by archive
+    member = re.match(r"(.*?)\((.*)\)$", path)
+    if member:
+        return os.path.basename(member.group(1))
+    norm = path.replace("\\", "/")
+    for marker, prefix in (("/lib/tinyusb/", "tinyusb"), ("/pico-sdk/", "sdk")):
+        if marker in norm:
+            parts = norm.split(marker, 1)[1].split("/")
+            # group by the library directory, e.g. sdk:hardware_adc, tinyusb:portable
+            lib = next((p for p in parts if p not in ("src", "rp2_common", "rp2040", "common")), parts[0])
+            return "%s:%s" % (prefix, lib)
+    name = os.path.basename(norm)
+    for suffix in (".obj", ".o"):
+        if name.endswith(suffix):
+            return name[: -len(suffix)]
+    return name
+
+def parse(map_path):
+    usage = collections.defaultdict(lambda: dict.fromkeys(CATEGORIES, 0))
+    in_memory_map = False
+    pending = None
+
+    with open(map_path, "r", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            m = SECTION_RE.match(line)
+            if m:
+                section, size, obj = m.group(1), int(m.group(3), 16), m.group(4)
+                pending = None
+            else:
+                m = NAME_ONLY_RE.match(line)
+                if m:
+                    pending = m.group(1)
+                    continue
+                m = ADDR_RE.match(line)
+                if not (m and pending):
+                    pending = None
+                    continue
+                section, size, obj = pending, int(m.group(2), 16), m.group(3)
+                pending = None
+
+            category = classify(section)
+            if category is None or size == 0 or obj.startswith("load address"):
+                continue
+            usage[module_of(obj)][category] += size
+    return usage
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("map", help="linker map file (e.g. pico_hid.elf.map)")
+    parser.add_argument("-o", "--output", help="also write the report to this file")
+    parser.add_argument("--ram-limit", type=int, default=SRAM_SIZE,
+                        help="fail if static RAM (ramtext + data + bss) exceeds this many bytes")
+    args = parser.parse_args()
+
+    usage = parse(args.map)
+    totals = dict.fromkeys(CATEGORIES, 0)
+    rows = sorted(usage.items(), key=lambda kv: -(kv[1]["text"] + kv[1]["ramtext"] + kv[1]["data"] + kv[1]["bss"]))
+
+    lines = ["%-32s %9s %9s %9s %9s %9s %9s" % ("module", "text", "ramtext", "data", "bss", "flash", "ram")]
+    for name, u in rows:
+        for c in CATEGORIES:
+            totals[c] += u[c]
+        flash = u["text"] + u["ramtext"] + u["data"]
+        ram = u["ramtext"] + u["data"] + u["bss"]
+        lines.append("%-32s %9d %9d %9d %9d %9d %9d" % (name, u["text"], u["ramtext"], u["data"], u["bss"], flash, ram))
+
+    flash = totals["text"] + totals["ramtext"] + totals["data"]
+    ram = totals["ramtext"] + totals["data"] + totals["bss"]
+    lines.append("%-32s %9d %9d %9d %9d %9d %9d" % ("TOTAL", totals["text"], totals["ramtext"], totals["data"],
+                                                   totals["bss"], flash, ram))
+    lines.append("static RAM %d of %d bytes (%.1f%%)" % (ram, args.ram_limit, 100.0 * ram / args.ram_limit))
+
+    report = "\n".join(lines)
+    print(report)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(report + "\n")
+
+    if ram > args.ram_limit:
+        print("error: static RAM budget exceeded", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
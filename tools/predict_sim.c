@@ -0,0 +1,158 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+//----------------------- Predictor Simulator -----------------------//
+// Replays a recorded stick trace through the firmware's predictor (predictor.c, built from the same
+// source) and reports how far the prediction is from what the stick actually did.
+//
+//   cc -O2 -I. -o predict_sim tools/predict_sim.c predictor.c -lm
+//   ./predict_sim trace.csv [--alpha 128] [--beta 32] [--horizon 3000] [--overshoot 64]
+//                           [--lead 3000] [--period 1000]
+//
+// The trace is CSV with one `t_us,value` line per sample (12-bit ADC codes, times increasing); lines
+// that do not start with a digit are skipped. Samples are fed to the predictor every --period us (as
+// the firmware converts blocks), and each prediction is made --lead us past the sample, the
+// sample-to-host-read latency. The truth is the trace interpolated at that time. The same error is
+// shown for simply holding the last sample, the behaviour with the predictor off.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "predictor.h"
+
+#define TRACE_MAX 1000000
+
+static uint32_t trace_t[TRACE_MAX];
+static uint16_t trace_v[TRACE_MAX];
+static size_t trace_len;
+
+static int load_trace(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); return 0; }
+
+  char line[128];
+  while (trace_len < TRACE_MAX && fgets(line, sizeof(line), f))
+  {
+    unsigned long t, v;
+    if (line[0] < '0' || line[0] > '9') continue;
+    if (sscanf(line, "%lu,%lu", &t, &v) != 2) continue;
+    trace_t[trace_len] = (uint32_t) t;
+    trace_v[trace_len] = (uint16_t) (v > PREDICTOR_CODE_MAX ? PREDICTOR_CODE_MAX : v);
+    trace_len++;
+  }
+  fclose(f);
+  return trace_len > 1;
+}
+
+// Trace value at time t, linear between samples; *index is a search hint that only moves forward
+static double trace_at(uint32_t t, size_t *index)
+{
+  while (*index + 1 < trace_len && trace_t[*index + 1] <= t) (*index)++;
+  if (*index + 1 >= trace_len) return trace_v[trace_len - 1];
+
+  double const t0 = trace_t[*index], t1 = trace_t[*index + 1];
+  double const f = t1 > t0 ? (t - t0) / (t1 - t0) : 0;
+  return trace_v[*index] + f * (trace_v[*index + 1] - trace_v[*index]);
+}
+
+typedef struct
+{
+  double sum_sq;
+  double max;
+  size_t count;
+} error_stats;
+
+static void add_error(error_stats *s, double e)
+{
+  s->sum_sq += e * e;
+  if (fabs(e) > s->max) s->max = fabs(e);
+  s->count++;
+}
+
+static void print_stats(const char *name, const error_stats *s)
+{
+  printf("%-10s rms %7.2f  max %7.1f codes\n", name, s->count ? sqrt(s->sum_sq / s->count) : 0.0, s->max);
+}
+
+int main(int argc, char **argv)
+{
+  predictor_config config = { .alpha_q8 = 128, .beta_q8 = 32, .horizon_us = 3000, .overshoot = 64 };
+  unsigned long lead_us = 3000, period_us = 1000;
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    unsigned long value = i + 1 < argc ? strtoul(argv[i + 1], NULL, 0) : 0;
+
+    if (arg[0] != '-') { path = arg; continue; }
+    if (i + 1 >= argc) { fprintf(stderr, "%s needs a value\n", arg); return 2; }
+    i++;
+    if      (!strcmp(arg, "--alpha"))     config.alpha_q8 = (uint8_t) value;
+    else if (!strcmp(arg, "--beta"))      config.beta_q8 = (uint8_t) value;
+    else if (!strcmp(arg, "--horizon"))   config.horizon_us = (uint16_t) value;
+    else if (!strcmp(arg, "--overshoot")) config.overshoot = (uint16_t) value;
+    else if (!strcmp(arg, "--lead"))      lead_us = value;
+    else if (!strcmp(arg, "--period"))    period_us = value ? value : 1;
+    else { fprintf(stderr, "unknown option %s\n", arg); return 2; }
+  }
+
+  if (!path || !load_trace(path))
+  {
+    fprintf(stderr, "usage: %s trace.csv [--alpha N] [--beta N] [--horizon us] [--overshoot codes] [--lead us] [--period us]\n", argv[0]);
+    return 2;
+  }
+
+  predictor p;
+  predictor_reset(&p);
+  error_stats predicted = { 0 }, held = { 0 };
+  size_t sample_index = 0, truth_index = 0;
+
+  if (lead_us >= trace_t[trace_len - 1] - trace_t[0])
+  {
+    fprintf(stderr, "--lead %lu us is not shorter than the trace\n", lead_us);
+    return 2;
+  }
+
+  // A lead of 0 compares the prediction at the sample time itself (the filtered value)
+  uint32_t const end = trace_t[trace_len - 1] - (uint32_t) lead_us;
+  for (uint32_t t = trace_t[0]; t <= end; t += (uint32_t) period_us)
+  {
+    uint16_t const z = (uint16_t) lround(trace_at(t, &sample_index));
+    predictor_update(&p, &config, z, t);
+
+    double const truth = trace_at(t + (uint32_t) lead_us, &truth_index);
+    add_error(&predicted, predictor_predict(&p, &config, t + (uint32_t) lead_us) - truth);
+    add_error(&held, z - truth);
+  }
+
+  printf("%zu samples, alpha %u/256, beta %u/256, horizon %u us, overshoot %u, lead %lu us, period %lu us\n",
+         predicted.count, config.alpha_q8, config.beta_q8, config.horizon_us, config.overshoot, lead_us, period_us);
+  print_stats("predicted", &predicted);
+  print_stats("held", &held);
+  return 0;
+}
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Simulated re-enumeration: measure the mount-to-first-report gap of a connected controller.
+
+Asks the device (telemetry command TELEMETRY_CMD_REENUMERATE) to detach from the bus and reattach,
+waits for it to come back, and reads the boot/mount timing page. Needs the `hid` package (hidapi).
+
+    python3 tools/reenum_gap.py [--cycles 20]
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import hid
+
+USB_VID = 0xACE9
+USB_PID = 0x4004  # Gamepad personality; the others are USB_PID | n << 5 (usb_descriptors.c)
+USB_PID_PERSONALITY_MASK = 0x7 << 5
+
+REPORT_ID_TELEMETRY = 2
+TELEMETRY_REPORT_SIZE = 63
+TELEMETRY_PAGE_BOOT = 1
+TELEMETRY_CMD_REENUMERATE = 1
+BOOT_MARK_COUNT = 5
+
+
+def controllers():
+    """hid.enumerate() entries of every controller, whichever personality it was powered up in."""
+    return [d for d in hid.enumerate(USB_VID) if (d["product_id"] & ~USB_PID_PERSONALITY_MASK) == USB_PID]
+
+
+def open_device(timeout_s=5.0):
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        for info in controllers():
+            dev = hid.device()
+            dev.open_path(info["path"])
+            return dev
+        time.sleep(0.01)
+    raise RuntimeError("controller did not re-enumerate within %.1f s" % timeout_s)
+
+
+def set_page(dev, page, command=0):
+    payload = bytes([REPORT_ID_TELEMETRY, page, command]) + bytes(TELEMETRY_REPORT_SIZE - 2)
+    dev.send_feature_report(payload)
+
+
+def read_boot_page(dev):
+    set_page(dev, TELEMETRY_PAGE_BOOT)
+    data = bytes(dev.get_feature_report(REPORT_ID_TELEMETRY, TELEMETRY_REPORT_SIZE + 1))
+    page, length = data[1], data[2]
+    if page != TELEMETRY_PAGE_BOOT or length < 4 * (BOOT_MARK_COUNT + 5):
+        raise RuntimeError("unexpected telemetry reply")
+    fields = struct.unpack_from("<%dI" % (BOOT_MARK_COUNT + 5), data, 3)
+    return {
+        "boot_to_mount_us": fields[BOOT_MARK_COUNT],
+        "mount_to_first_report_us": fields[BOOT_MARK_COUNT + 1],
+        "mount_count": fields[BOOT_MARK_COUNT + 2],
+        "last_gap_us": fields[BOOT_MARK_COUNT + 3],
+        "max_gap_us": fields[BOOT_MARK_COUNT + 4],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cycles", type=int, default=10, help="number of re-enumerations")
+    args = parser.parse_args()
+    if args.cycles < 1:
+        parser.error("--cycles must be at least 1")
+
+    dev = open_device()
+    before = read_boot_page(dev)
+    print("boot-to-mount %d us, first mount-to-report %d us" %
+          (before["boot_to_mount_us"], before["mount_to_first_report_us"]))
+
+    for cycle in range(args.cycles):
+        mounts = read_boot_page(dev)["mount_count"]
+        set_page(dev, TELEMETRY_PAGE_BOOT, TELEMETRY_CMD_REENUMERATE)
+        dev.close()
+        time.sleep(0.05)
+
+        while True:
+            dev = open_device()
+            stats = read_boot_page(dev)
+            if stats["mount_count"] > mounts:
+                break
+            dev.close()
+            time.sleep(0.01)
+        print("cycle %2d: mount-to-first-report %d us" % (cycle, stats["last_gap_us"]))
+
+    print("worst gap over %d mounts: %d us" % (stats["mount_count"], stats["max_gap_us"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
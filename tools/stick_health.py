@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Read the stick health statistics from every connected controller and flag worn sticks.
+
+Reads the telemetry HEALTH page (see axis_health.h) of each controller and prints one line per axis.
+An axis is flagged when:
+
+    range   the stick has been exercised but no longer reaches the ends of its travel
+    spikes  the wiper loses contact (isolated jumps) more often than --max-spike-ppm
+    noise   the quietest it gets at rest is above --max-noise codes RMS
+
+    python3 tools/stick_health.py                  # all controllers
+    python3 tools/stick_health.py --csv fleet.csv  # also append the raw numbers for trending
+    python3 tools/stick_health.py --reset          # start over, e.g. after replacing sticks
+
+Exits with status 1 if any axis is flagged. Needs the `hid` package (hidapi).
+"""
+
+import argparse
+import csv
+import math
+import os
+import struct
+import sys
+import time
+
+import hid
+
+USB_VID = 0xACE9
+USB_PID = 0x4004  # Gamepad personality; the others are USB_PID | n << 5 (usb_descriptors.c)
+USB_PID_PERSONALITY_MASK = 0x7 << 5
+
+REPORT_ID_TELEMETRY = 2
+TELEMETRY_REPORT_SIZE = 63
+TELEMETRY_PAGE_HEALTH = 6
+TELEMETRY_CMD_HEALTH_RESET = 2
+
+AXIS_NAMES = ["X", "Y"]
+AXIS_FORMAT = "<HHIHHHI"
+AXIS_SIZE = struct.calcsize(AXIS_FORMAT)
+
+EXERCISED_SPAN = 3000    # min..max span that shows the stick has been pushed to its ends
+END_MARGIN = 64          # codes from 0 / 4095 a healthy stick reaches
+
+
+def controllers():
+    """hid.enumerate() entries of every controller, whichever personality it was powered up in."""
+    return [d for d in hid.enumerate(USB_VID) if (d["product_id"] & ~USB_PID_PERSONALITY_MASK) == USB_PID]
+
+
+def select_health(dev, command=0):
+    dev.send_feature_report(bytes([REPORT_ID_TELEMETRY, TELEMETRY_PAGE_HEALTH, command]) +
+                            bytes(TELEMETRY_REPORT_SIZE - 2))
+
+
+def read_health(dev):
+    select_health(dev)
+    data = bytes(dev.get_feature_report(REPORT_ID_TELEMETRY, TELEMETRY_REPORT_SIZE + 1))
+    page, length = data[1], data[2]
+    if page != TELEMETRY_PAGE_HEALTH or length < 4 + AXIS_SIZE * len(AXIS_NAMES):
+        raise RuntimeError("unexpected telemetry reply")
+
+    samples, = struct.unpack_from("<I", data, 3)
+    axes = []
+    for i, name in enumerate(AXIS_NAMES):
+        mn, mx, spikes, var, var_max, floor, windows = struct.unpack_from(AXIS_FORMAT, data, 7 + i * AXIS_SIZE)
+        axes.append({
+            "axis": name, "min": mn, "max": mx, "spikes": spikes, "windows": windows,
+            "noise_rms": math.sqrt(floor / 256), "last_rms": math.sqrt(var / 256),
+            "worst_rms": math.sqrt(var_max / 256),
+        })
+    return samples, axes
+
+
+def flags_for(axis, samples, args):
+    flags = []
+    if axis["max"] - axis["min"] >= EXERCISED_SPAN and (axis["min"] > END_MARGIN or axis["max"] < 4095 - END_MARGIN):
+        flags.append("range")
+    if samples and axis["spikes"] * 1e6 / samples > args.max_spike_ppm:
+        flags.append("spikes")
+    if axis["windows"] and axis["noise_rms"] > args.max_noise:
+        flags.append("noise")
+    return flags
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--max-spike-ppm", type=float, default=5.0, help="spikes per million samples")
+    parser.add_argument("--max-noise", type=float, default=3.0, help="noise floor in ADC codes RMS")
+    parser.add_argument("--csv", help="append the readings to this CSV file")
+    parser.add_argument("--reset", action="store_true", help="clear the statistics after reading them")
+    args = parser.parse_args()
+
+    rows = []
+    flagged = False
+    for info in controllers():
+        dev = hid.device()
+        dev.open_path(info["path"])
+        try:
+            samples, axes = read_health(dev)
+            # Only once the page has been read; the reset would otherwise race the read
+            if args.reset:
+                select_health(dev, TELEMETRY_CMD_HEALTH_RESET)
+        finally:
+            dev.close()
+
+        for axis in axes:
+            flags = flags_for(axis, samples, args)
+            flagged |= bool(flags)
+            print("%-16s %s  range %4d..%4d  spikes %6d  noise %.2f (last %.2f, worst %.2f)  %s" %
+                  (info["serial_number"], axis["axis"], axis["min"], axis["max"], axis["spikes"],
+                   axis["noise_rms"], axis["last_rms"], axis["worst_rms"], ",".join(flags) or "ok"))
+            rows.append(dict(axis, serial=info["serial_number"], samples=samples, flags=" ".join(flags),
+                             time=int(time.time())))
+
+    if not rows:
+        print("no controllers found")
+        return 1
+
+    if args.csv:
+        new_file = not os.path.exists(args.csv)
+        with open(args.csv, "a", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+            if new_file:
+                writer.writeheader()
+            writer.writerows(rows)
+
+    return 1 if flagged else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
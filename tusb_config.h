@@ -98,11 +98,16 @@
 #define CFG_TUD_HID               1
 #define CFG_TUD_CDC               0
 #define CFG_TUD_MSC               0
-#define CFG_TUD_MIDI              0
+#define CFG_TUD_MIDI              1  // Only enumerated by the MIDI personality (usb_descriptors.c)
 #define CFG_TUD_VENDOR            0
 
 // HID buffer size Should be sufficient to hold ID (if any) + Data
-#define CFG_TUD_HID_EP_BUFSIZE    32
+// Also bounds GET/SET_REPORT on the control pipe, so it covers the 63 byte vendor feature reports
+#define CFG_TUD_HID_EP_BUFSIZE    64
+
+// MIDI FIFOs: the TX one holds a burst of events while the previous packet waits for the host
+#define CFG_TUD_MIDI_RX_BUFSIZE   64
+#define CFG_TUD_MIDI_TX_BUFSIZE   256
 
 #ifdef __cplusplus
  }
@@ -27,6 +27,13 @@
 
 #ifndef JUST_STDIO
 #include "usb_descriptors.h"
+#include "telemetry.h"
+#include "fw_update.h"
+#include "calibration.h"
+#include "button_stats.h"
+#include "personality.h"
+#include "switch_pad.h"
+#include "pico/unique_id.h"
 
 /* A combination of interfaces must have a unique product id, since PC will save device driver after the first plug.
  * Same VID/PID with different interface e.g MSC (first), then CDC (later) will possibly cause system error on PC.
@@ -35,12 +42,16 @@
  *   [MSB]         HID | MSC | CDC          [LSB]
  */
 #define _PID_MAP(itf, n)  ( (CFG_TUD_##itf) << (n) )
-#define USB_PID           (0x4000 | _PID_MAP(CDC, 0) | _PID_MAP(MSC, 1) | _PID_MAP(HID, 2) | \
-                           _PID_MAP(MIDI, 3) | _PID_MAP(VENDOR, 4) )
+#define USB_PID           (0x4000 | _PID_MAP(CDC, 0) | _PID_MAP(MSC, 1) | _PID_MAP(HID, 2) | _PID_MAP(VENDOR, 4) )
+// MIDI is left out of the map: only the MIDI personality has the interface, and its personality bits
+// already give it a product ID of its own
 
 #define USB_VID   0xAce9
 #define USB_BCD   0x0200
 
+// Each personality (personality.h) gets its own product ID above the interface bits
+#define USB_PID_PERSONALITY_SHIFT 5
+
 //--------------------------------------------------------------------+
 // Device Descriptors
 //--------------------------------------------------------------------+
@@ -69,17 +80,74 @@ tusb_desc_device_t const desc_device =
 // Application return pointer to descriptor
 uint8_t const * tud_descriptor_device_cb(void)
 {
-  return (uint8_t const *) &desc_device;
+  static tusb_desc_device_t desc;
+  desc = desc_device;
+  desc.idProduct = (uint16_t) (USB_PID | (personality() << USB_PID_PERSONALITY_SHIFT));
+  if (personality() == PERSONALITY_SWITCH)
+  {
+    desc.idVendor = SWITCH_VID;  // The console only accepts pads it knows
+    desc.idProduct = SWITCH_PID;
+  }
+  return (uint8_t const *) &desc;
 }
 
 //--------------------------------------------------------------------+
 // HID Report Descriptor
 //--------------------------------------------------------------------+
 
+// Vendor feature reports, the same in every personality
+#define DESC_VENDOR_FEATURES \
+  TUD_HID_REPORT_DESC_VENDOR_FEATURE ( 0x01, TELEMETRY_REPORT_SIZE, HID_REPORT_ID(REPORT_ID_TELEMETRY) ),\
+  TUD_HID_REPORT_DESC_VENDOR_FEATURE ( 0x02, FW_UPDATE_REPORT_SIZE, HID_REPORT_ID(REPORT_ID_FW_UPDATE) ),\
+  TUD_HID_REPORT_DESC_VENDOR_FEATURE ( 0x03, CAL_REPORT_SIZE, HID_REPORT_ID(REPORT_ID_CALIBRATION) ),\
+  TUD_HID_REPORT_DESC_VENDOR_FEATURE ( 0x04, BUTTON_STATS_REPORT_SIZE, HID_REPORT_ID(REPORT_ID_BUTTON_STATS) )
+
 uint8_t const desc_hid_report[] =
 {
   // TUD_HID_REPORT_DESC_CONSUMER( HID_REPORT_ID(REPORT_ID_CONSUMER_CONTROL )),
-  TUD_HID_REPORT_DESC_GAMEPAD ( HID_REPORT_ID(REPORT_ID_GAMEPAD          ))
+  TUD_HID_REPORT_DESC_GAMEPAD ( HID_REPORT_ID(REPORT_ID_GAMEPAD          )),
+  DESC_VENDOR_FEATURES
+};
+
+uint8_t const desc_hid_report_wheel[] =
+{
+  TUD_HID_REPORT_DESC_WHEEL ( HID_REPORT_ID(REPORT_ID_WHEEL) ),
+  DESC_VENDOR_FEATURES
+};
+
+uint8_t const desc_hid_report_keyboard[] =
+{
+  TUD_HID_REPORT_DESC_KEYBOARD_NKRO ( HID_REPORT_ID(REPORT_ID_KEYBOARD) ),
+  DESC_VENDOR_FEATURES
+};
+
+uint8_t const desc_hid_report_mouse[] =
+{
+  TUD_HID_REPORT_DESC_MOUSE16 ( HID_REPORT_ID(REPORT_ID_MOUSE) ),
+  DESC_VENDOR_FEATURES
+};
+
+uint8_t const desc_hid_report_switch[] =
+{
+  TUD_HID_REPORT_DESC_SWITCH ()
+};
+
+// MIDI and JVS personalities: no input report, the HID interface is only there for the feature reports
+uint8_t const desc_hid_report_features[] =
+{
+  DESC_VENDOR_FEATURES
+};
+
+// Report descriptor of each personality
+static uint8_t const * const desc_hid_reports[PERSONALITY_COUNT] =
+{
+  [PERSONALITY_GAMEPAD]  = desc_hid_report,
+  [PERSONALITY_WHEEL]    = desc_hid_report_wheel,
+  [PERSONALITY_KEYBOARD] = desc_hid_report_keyboard,
+  [PERSONALITY_MOUSE]    = desc_hid_report_mouse,
+  [PERSONALITY_SWITCH]   = desc_hid_report_switch,
+  [PERSONALITY_MIDI]     = desc_hid_report_features,
+  [PERSONALITY_JVS]      = desc_hid_report_features,
 };
 
 // Invoked when received GET HID REPORT DESCRIPTOR
@@ -88,7 +156,7 @@ uint8_t const desc_hid_report[] =
 uint8_t const * tud_hid_descriptor_report_cb(uint8_t instance)
 {
   (void) instance;
-  return desc_hid_report;
+  return desc_hid_reports[personality()];
 }
 
 //--------------------------------------------------------------------+
@@ -101,24 +169,74 @@ enum
   ITF_NUM_TOTAL
 };
 
-#define  CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+// MIDI personality: audio control and MIDI streaming interfaces after the HID one
+enum
+{
+  ITF_NUM_MIDI = ITF_NUM_TOTAL,
+  ITF_NUM_MIDI_STREAMING,
+  ITF_NUM_MIDI_TOTAL
+};
 
-#define EPNUM_HID   0x81
+#define  CONFIG_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN)
+#define  CONFIG_SWITCH_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_INOUT_DESC_LEN)
+#define  CONFIG_MIDI_TOTAL_LEN  (TUD_CONFIG_DESC_LEN + TUD_HID_DESC_LEN + TUD_MIDI_DESC_LEN)
+
+#define EPNUM_HID       0x81
+#define EPNUM_HID_OUT   0x02  // Switch personality only
+#define EPNUM_MIDI_OUT  0x03  // MIDI personality only
+#define EPNUM_MIDI_IN   0x83
+
+// The same HID interface in every personality; only the report descriptor length differs
+#define DESC_CONFIGURATION(report_len) \
+  /* Config number, interface count, string index, total length, attribute, power in mA */\
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),\
+  /* Interface number, string index, protocol, report descriptor len, EP In address, size & polling interval */\
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, report_len, EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, 1)
+
+uint8_t const desc_configuration[] = { DESC_CONFIGURATION(sizeof(desc_hid_report)) };
+uint8_t const desc_configuration_wheel[] = { DESC_CONFIGURATION(sizeof(desc_hid_report_wheel)) };
+uint8_t const desc_configuration_keyboard[] = { DESC_CONFIGURATION(sizeof(desc_hid_report_keyboard)) };
+uint8_t const desc_configuration_mouse[] = { DESC_CONFIGURATION(sizeof(desc_hid_report_mouse)) };
+uint8_t const desc_configuration_features[] = { DESC_CONFIGURATION(sizeof(desc_hid_report_features)) };
+
+// As the original pad: bus powered at 500 mA, an OUT endpoint next to the IN one, its polling interval
+uint8_t const desc_configuration_switch[] =
+{
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_SWITCH_TOTAL_LEN, 0, 500),
+  TUD_HID_INOUT_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_switch), EPNUM_HID_OUT, EPNUM_HID,
+                           CFG_TUD_HID_EP_BUFSIZE, SWITCH_POLL_INTERVAL_MS)
+};
 
-uint8_t const desc_configuration[] =
+uint8_t const desc_configuration_midi[] =
 {
-  // Config number, interface count, string index, total length, attribute, power in mA
-  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+  TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_MIDI_TOTAL, 0, CONFIG_MIDI_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report_features), EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, 1),
+  /* Interface number, string index, EP Out & EP In address, EP size */
+  TUD_MIDI_DESCRIPTOR(ITF_NUM_MIDI, 0, EPNUM_MIDI_OUT, EPNUM_MIDI_IN, 64)
+};
 
-  // Interface number, string index, protocol, report descriptor len, EP In address, size & polling interval
-  TUD_HID_DESCRIPTOR(ITF_NUM_HID, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_hid_report), EPNUM_HID, CFG_TUD_HID_EP_BUFSIZE, 5)
+static uint8_t const * const desc_configurations[PERSONALITY_COUNT] =
+{
+  [PERSONALITY_GAMEPAD]  = desc_configuration,
+  [PERSONALITY_WHEEL]    = desc_configuration_wheel,
+  [PERSONALITY_KEYBOARD] = desc_configuration_keyboard,
+  [PERSONALITY_MOUSE]    = desc_configuration_mouse,
+  [PERSONALITY_SWITCH]   = desc_configuration_switch,
+  [PERSONALITY_MIDI]     = desc_configuration_midi,
+  [PERSONALITY_JVS]      = desc_configuration_features,
 };
 
+// Configuration of the boot personality
+static uint8_t const * configuration(void)
+{
+  return desc_configurations[personality()];
+}
+
 #if TUD_OPT_HIGH_SPEED
 // Per USB specs: high speed capable device must report device_qualifier and other_speed_configuration
 
-// other speed configuration
-uint8_t desc_other_speed_config[CONFIG_TOTAL_LEN];
+// other speed configuration, sized for the longest personality configuration (MIDI)
+uint8_t desc_other_speed_config[CONFIG_MIDI_TOTAL_LEN];
 
 // device qualifier is mostly similar to device descriptor since we don't change configuration based on speed
 tusb_desc_device_qualifier_t const desc_device_qualifier =
@@ -153,7 +271,8 @@ uint8_t const* tud_descriptor_other_speed_configuration_cb(uint8_t index)
   (void) index; // for multiple configurations
 
   // other speed config is basically configuration with type = OHER_SPEED_CONFIG
-  memcpy(desc_other_speed_config, desc_configuration, CONFIG_TOTAL_LEN);
+  uint8_t const *config = configuration();
+  memcpy(desc_other_speed_config, config, config[2] | (config[3] << 8));
   desc_other_speed_config[1] = TUSB_DESC_OTHER_SPEED_CONFIG;
 
   // this example use the same configuration for both high and full speed mode
@@ -170,7 +289,7 @@ uint8_t const * tud_descriptor_configuration_cb(uint8_t index)
   (void) index; // for multiple configurations
 
   // This example use the same configuration for both high and full speed mode
-  return desc_configuration;
+  return configuration();
 }
 
 //--------------------------------------------------------------------+
@@ -183,9 +302,15 @@ char const* string_desc_arr [] =
   (const char[]) { 0x09, 0x04 }, // 0: is supported language is English (0x0409)
   "TinyUSB",                     // 1: Manufacturer
   "TinyUSB Device",              // 2: Product
-  "123456",                      // 3: Serials, should use chip ID
+  NULL,                          // 3: Serial, filled in from the flash chip's unique ID
 };
 
+// Manufacturer and product of the original pad, for the Switch personality
+static char const* const string_desc_switch[] = { NULL, "HORI CO.,LTD.", "POKKEN CONTROLLER" };
+
+// Unique per board so host tools can tell controllers apart (and find them again after a reboot)
+static char serial_str[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+
 static uint16_t _desc_str[32];
 
 // Invoked when received GET STRING DESCRIPTOR request
@@ -208,6 +333,13 @@ uint16_t const* tud_descriptor_string_cb(uint8_t index, uint16_t langid)
     if ( !(index < sizeof(string_desc_arr)/sizeof(string_desc_arr[0])) ) return NULL;
 
     const char* str = string_desc_arr[index];
+    if ( personality() == PERSONALITY_SWITCH && index < 3 ) str = string_desc_switch[index];
+
+    if ( index == 3 )
+    {
+      if ( !serial_str[0] ) pico_get_unique_board_id_string(serial_str, sizeof(serial_str));
+      str = serial_str;
+    }
 
     // Cap at max char
     chr_count = strlen(str);
@@ -29,7 +29,167 @@ enum
 {
   // REPORT_ID_CONSUMER_CONTROL = 1,
   REPORT_ID_GAMEPAD = 1,
+  REPORT_ID_TELEMETRY,     // Vendor feature report, see telemetry.h
+  REPORT_ID_FW_UPDATE,     // Vendor feature report, see fw_update.h
+  REPORT_ID_CALIBRATION,   // Vendor feature report, see calibration.h
+  REPORT_ID_BUTTON_STATS,  // Vendor feature report, see button_stats.h
+  REPORT_ID_WHEEL,         // Input report of the wheel personality, see wheel.h
+  REPORT_ID_KEYBOARD,      // Input report of the keyboard personality, see keyboard.h
+  REPORT_ID_MOUSE,         // Input report of the mouse personality, see mouse.h
   REPORT_ID_COUNT
 };
 
+#define REPORT_ID_SWITCH 0  // The Switch personality's only report has no ID, see switch_pad.h
+
+// Vendor-defined feature report carrying `count` opaque bytes, used for telemetry and configuration
+#define TUD_HID_REPORT_DESC_VENDOR_FEATURE(usage, count, ...) \
+  HID_USAGE_PAGE_N ( HID_USAGE_PAGE_VENDOR, 2 ),\
+  HID_USAGE        ( usage                    ),\
+  HID_COLLECTION   ( HID_COLLECTION_APPLICATION ),\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    HID_USAGE        ( usage                  ),\
+    HID_LOGICAL_MIN  ( 0x00                   ),\
+    HID_LOGICAL_MAX_N( 0xff, 2                ),\
+    HID_REPORT_SIZE  ( 8                      ),\
+    HID_REPORT_COUNT ( count                  ),\
+    HID_FEATURE      ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+  HID_COLLECTION_END \
+
+// Wheel: 16-bit steering (X) and pedals (Y accelerator, Z brake, Rz clutch), 32 buttons; see hid_wheel_report_t
+#define TUD_HID_REPORT_DESC_WHEEL(...) \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP     ),\
+  HID_USAGE      ( HID_USAGE_DESKTOP_JOYSTICK ),\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION ),\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    /* 16 bit X, Y, Z, Rz (0..65535, needs a 4 byte logical max) */\
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_DESKTOP ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_X    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_Y    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_Z    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_RZ   ),\
+    HID_LOGICAL_MIN    ( 0x00                   ),\
+    HID_LOGICAL_MAX_N  ( 0xffff, 3              ),\
+    HID_REPORT_COUNT   ( 4                      ),\
+    HID_REPORT_SIZE    ( 16                     ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+    /* 32 bit Button Map */\
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_BUTTON  ),\
+    HID_USAGE_MIN      ( 1                      ),\
+    HID_USAGE_MAX      ( 32                     ),\
+    HID_LOGICAL_MIN    ( 0                      ),\
+    HID_LOGICAL_MAX    ( 1                      ),\
+    HID_REPORT_COUNT   ( 32                     ),\
+    HID_REPORT_SIZE    ( 1                      ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+  HID_COLLECTION_END \
+
+// N-key-rollover keyboard: modifier byte (0xE0-0xE7), then one bit per keycode 0-127; see hid_nkro_report_t
+#define TUD_HID_REPORT_DESC_KEYBOARD_NKRO(...) \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP     ),\
+  HID_USAGE      ( HID_USAGE_DESKTOP_KEYBOARD ),\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION ),\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    /* 8 bits Modifier Keys (Shift, Control, Alt, GUI) */\
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_KEYBOARD ),\
+    HID_USAGE_MIN      ( 224                     ),\
+    HID_USAGE_MAX      ( 231                     ),\
+    HID_LOGICAL_MIN    ( 0                       ),\
+    HID_LOGICAL_MAX    ( 1                       ),\
+    HID_REPORT_COUNT   ( 8                       ),\
+    HID_REPORT_SIZE    ( 1                       ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+    /* 128 bit key bitmap */\
+    HID_USAGE_MIN      ( 0                       ),\
+    HID_USAGE_MAX      ( 127                     ),\
+    HID_REPORT_COUNT_N ( 128, 2                  ),\
+    HID_REPORT_SIZE    ( 1                       ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+  HID_COLLECTION_END \
+
+// Mouse with 5 buttons and 16-bit relative X, Y; see hid_mouse16_report_t
+#define TUD_HID_REPORT_DESC_MOUSE16(...) \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP      ),\
+  HID_USAGE      ( HID_USAGE_DESKTOP_MOUSE     ),\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION  ),\
+    /* Report ID if any */\
+    __VA_ARGS__ \
+    HID_USAGE      ( HID_USAGE_DESKTOP_POINTER ),\
+    HID_COLLECTION ( HID_COLLECTION_PHYSICAL   ),\
+      /* 5 buttons, 3 bit padding */\
+      HID_USAGE_PAGE     ( HID_USAGE_PAGE_BUTTON  ),\
+      HID_USAGE_MIN      ( 1                      ),\
+      HID_USAGE_MAX      ( 5                      ),\
+      HID_LOGICAL_MIN    ( 0                      ),\
+      HID_LOGICAL_MAX    ( 1                      ),\
+      HID_REPORT_COUNT   ( 5                      ),\
+      HID_REPORT_SIZE    ( 1                      ),\
+      HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+      HID_REPORT_COUNT   ( 1                      ),\
+      HID_REPORT_SIZE    ( 3                      ),\
+      HID_INPUT          ( HID_CONSTANT           ),\
+      /* 16 bit relative X, Y */\
+      HID_USAGE_PAGE     ( HID_USAGE_PAGE_DESKTOP ),\
+      HID_USAGE          ( HID_USAGE_DESKTOP_X    ),\
+      HID_USAGE          ( HID_USAGE_DESKTOP_Y    ),\
+      HID_LOGICAL_MIN_N  ( -32767, 2              ),\
+      HID_LOGICAL_MAX_N  ( 32767, 2               ),\
+      HID_REPORT_COUNT   ( 2                      ),\
+      HID_REPORT_SIZE    ( 16                     ),\
+      HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_RELATIVE ),\
+    HID_COLLECTION_END, \
+  HID_COLLECTION_END \
+
+// HORI Pokken Tournament Pro Pad, byte for byte: 16 buttons, hat, 4 x 8 bit sticks, a vendor byte and an
+// 8 byte vendor output report; no report ID. See hid_switch_report_t
+#define TUD_HID_REPORT_DESC_SWITCH() \
+  HID_USAGE_PAGE ( HID_USAGE_PAGE_DESKTOP     ),\
+  HID_USAGE      ( HID_USAGE_DESKTOP_GAMEPAD  ),\
+  HID_COLLECTION ( HID_COLLECTION_APPLICATION ),\
+    /* 16 bit Button Map */\
+    HID_LOGICAL_MIN    ( 0                      ),\
+    HID_LOGICAL_MAX    ( 1                      ),\
+    HID_PHYSICAL_MIN   ( 0                      ),\
+    HID_PHYSICAL_MAX   ( 1                      ),\
+    HID_REPORT_SIZE    ( 1                      ),\
+    HID_REPORT_COUNT   ( 16                     ),\
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_BUTTON  ),\
+    HID_USAGE_MIN      ( 1                      ),\
+    HID_USAGE_MAX      ( 16                     ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+    /* 4 bit hat, 0-7 clockwise from up, 8 = null; 4 bit padding */\
+    HID_USAGE_PAGE     ( HID_USAGE_PAGE_DESKTOP ),\
+    HID_LOGICAL_MAX    ( 7                      ),\
+    HID_PHYSICAL_MAX_N ( 315, 2                 ),\
+    HID_REPORT_SIZE    ( 4                      ),\
+    HID_REPORT_COUNT   ( 1                      ),\
+    HID_UNIT           ( 0x14                   ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_HAT_SWITCH ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE | HID_NULL_STATE ),\
+    HID_UNIT           ( 0x00                   ),\
+    HID_REPORT_COUNT   ( 1                      ),\
+    HID_INPUT          ( HID_CONSTANT           ),\
+    /* 8 bit X, Y, Z, Rz */\
+    HID_LOGICAL_MAX_N  ( 0xff, 2                ),\
+    HID_PHYSICAL_MAX_N ( 0xff, 2                ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_X    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_Y    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_Z    ),\
+    HID_USAGE          ( HID_USAGE_DESKTOP_RZ   ),\
+    HID_REPORT_SIZE    ( 8                      ),\
+    HID_REPORT_COUNT   ( 4                      ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+    /* Vendor byte in, 8 vendor bytes out */\
+    HID_USAGE_PAGE_N   ( HID_USAGE_PAGE_VENDOR, 2 ),\
+    HID_USAGE          ( 0x20                   ),\
+    HID_REPORT_COUNT   ( 1                      ),\
+    HID_INPUT          ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+    HID_USAGE_N        ( 0x2621, 2              ),\
+    HID_REPORT_COUNT   ( 8                      ),\
+    HID_OUTPUT         ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ),\
+  HID_COLLECTION_END \
+
+
 #endif /* USB_DESCRIPTORS_H_ */
\ No newline at end of file
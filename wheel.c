@@ -0,0 +1,152 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "wheel.h"
+#include "quadrature.h"
+#include "cpu_load.h"
+
+//----------------------- Steering -----------------------//
+static int encoder = -1;                      // quadrature.h
+static int32_t center;                        // Count at the center of the wheel
+static int32_t half_lock = WHEEL_LOCK_DEFAULT_DEG * WHEEL_COUNTS_PER_REV / 720;  // Counts from center to lock
+static uint16_t lock_deg = WHEEL_LOCK_DEFAULT_DEG;
+static int32_t position;                      // Counts from center at the last report
+
+static uint16_t steering_axis(int32_t count)
+{
+  position = count - center;  // Wraps correctly across the 32-bit counter overflow
+  int32_t p = position;
+  if (p > half_lock) p = half_lock;
+  if (p < -half_lock) p = -half_lock;
+  int32_t const axis = WHEEL_STEERING_CENTER + p * 32767 / half_lock;
+  return (uint16_t) axis;
+}
+
+void wheel_set_lock(uint16_t degrees)
+{
+  if (degrees < WHEEL_LOCK_MIN_DEG) degrees = WHEEL_LOCK_MIN_DEG;
+  if (degrees > WHEEL_LOCK_MAX_DEG) degrees = WHEEL_LOCK_MAX_DEG;
+  lock_deg = degrees;
+  half_lock = (int32_t) degrees * WHEEL_COUNTS_PER_REV / 720;
+}
+
+void wheel_recenter(void)
+{
+  if (encoder >= 0) center = quadrature_count(encoder);
+}
+
+//----------------------- Pedals -----------------------//
+// Curves as 17 points over the scaled travel, interpolated linearly in between
+#define PEDAL_CURVE_POINTS 17
+
+static const uint16_t pedal_curves[PEDAL_CURVE_COUNT][PEDAL_CURVE_POINTS] =
+{
+  [PEDAL_CURVE_LINEAR] =      { 0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768,
+                                36864, 40960, 45056, 49152, 53248, 57344, 61440, 65535 },
+  [PEDAL_CURVE_PROGRESSIVE] = { 0, 256, 1024, 2304, 4096, 6400, 9216, 12544, 16384,
+                                20736, 25600, 30976, 36864, 43264, 50176, 57600, 65535 },
+  [PEDAL_CURVE_AGGRESSIVE] =  { 0, 7936, 15360, 22272, 28672, 34560, 39936, 44800, 49152,
+                                52992, 56320, 59136, 61440, 63232, 64512, 65280, 65535 },
+};
+
+typedef struct
+{
+  uint8_t mux_channel;  // Analog mux channel of the potentiometer
+  uint16_t rest;        // Linearised 12-bit value released (may be above `full` for a reversed pot)
+  uint16_t full;        // Linearised 12-bit value fully pressed
+  uint8_t curve;        // pedal_curve
+} pedal_config;
+
+// Pedal configuration, in report order. The rest and full values leave a little dead travel at both
+// ends, so a released pedal reads 0 and a floored one 65535 despite noise.
+static pedal_config _pedal_config[WHEEL_PEDAL_COUNT] = {
+    {0, 200, 3900, PEDAL_CURVE_LINEAR},       // Accelerator on mux channel 0
+    {1, 200, 3900, PEDAL_CURVE_PROGRESSIVE},  // Brake on mux channel 1
+    {2, 200, 3900, PEDAL_CURVE_LINEAR},       // Clutch on mux channel 2
+};
+
+static uint16_t pedal_axis(const pedal_config *pedal, uint16_t raw)
+{
+  int32_t const span = (int32_t) pedal->full - pedal->rest;
+  int32_t t = ((int32_t) raw - pedal->rest) * 65535 / span;  // Negative span flips a reversed pot
+  if (t < 0) t = 0;
+  if (t >= 65535) return pedal_curves[pedal->curve][PEDAL_CURVE_POINTS - 1];
+
+  const uint16_t *curve = pedal_curves[pedal->curve];
+  uint32_t const seg = (uint32_t) t >> 12;
+  uint32_t const frac = (uint32_t) t & 0xFFF;
+  return (uint16_t) (curve[seg] + (((int32_t) curve[seg + 1] - curve[seg]) * (int32_t) frac >> 12));
+}
+
+bool wheel_set_pedal(uint8_t pedal, uint16_t rest, uint16_t full, uint8_t curve)
+{
+  if (pedal >= WHEEL_PEDAL_COUNT || curve >= PEDAL_CURVE_COUNT || rest == full) return false;
+  _pedal_config[pedal].rest = rest;
+  _pedal_config[pedal].full = full;
+  _pedal_config[pedal].curve = curve;
+  return true;
+}
+
+//----------------------- Report -----------------------//
+static hid_wheel_report_t last;  // Last report built, for telemetry
+
+void wheel_init(void)
+{
+  encoder = quadrature_start(WHEEL_ENCODER_PIN_A);
+  wheel_recenter();  // The wheel rests at its center at power-up
+}
+
+void wheel_update_report(hid_wheel_report_t *report)
+{
+  cpu_load_enter();
+  const input_snapshot_t *input = input_refresh();
+  if (input)
+  {
+    report->steering = steering_axis(quadrature_count(encoder));
+    report->accelerator = pedal_axis(&_pedal_config[0], input->mux[_pedal_config[0].mux_channel]);
+    report->brake = pedal_axis(&_pedal_config[1], input->mux[_pedal_config[1].mux_channel]);
+    report->clutch = pedal_axis(&_pedal_config[2], input->mux[_pedal_config[2].mux_channel]);
+    report->buttons = input->buttons;
+    last = *report;
+  }
+  cpu_load_exit();
+}
+
+// Telemetry page: i32 position (counts from center), u16 lock (degrees), u16 steering, u16 accelerator,
+// u16 brake, u16 clutch
+uint16_t wheel_telemetry(uint8_t *buf, uint16_t len)
+{
+  if (len < 14) return 0;
+
+  memcpy(&buf[0], &position, 4);
+  memcpy(&buf[4], &lock_deg, 2);
+  memcpy(&buf[6], &last.steering, 2);
+  memcpy(&buf[8], &last.accelerator, 2);
+  memcpy(&buf[10], &last.brake, 2);
+  memcpy(&buf[12], &last.clutch, 2);
+  return 14;
+}
@@ -0,0 +1,74 @@
+/* 
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Ha Thach (tinyusb.org)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef WHEEL_H_
+#define WHEEL_H_
+
+#include <stdint.h>
+#include "pico_hid.h"
+
+//----------------------- Wheel Personality -----------------------//
+// Steering wheel with an optical quadrature encoder and three potentiometer pedals on the analog mux.
+// The encoder is counted in PIO (quadrature.h), so no step is ever lost between reports. The
+// position relative to the center maps the lock-to-lock rotation onto the full 16-bit steering axis.
+//
+// Each pedal is scaled from its resting and fully pressed raw values to 16 bits and then shaped by a
+// response curve. The wheel is centered where it is at power-up; calibration ops change the lock,
+// recenter it, and set the pedal ranges and curves (not stored).
+#define WHEEL_ENCODER_PIN_A      14     // Phase B on the next pin (15), both pulled up
+#define WHEEL_COUNTS_PER_REV     2400   // Quadrature counts per turn: 600-line encoder x4
+#define WHEEL_LOCK_DEFAULT_DEG   900
+#define WHEEL_LOCK_MIN_DEG       90
+#define WHEEL_LOCK_MAX_DEG       3600
+#define WHEEL_PEDAL_COUNT        3      // Accelerator, brake, clutch
+
+typedef enum
+{
+  PEDAL_CURVE_LINEAR = 0,
+  PEDAL_CURVE_PROGRESSIVE,  // Fine control at the start of the travel (x^2), e.g. for the brake
+  PEDAL_CURVE_AGGRESSIVE,   // Most of the output early in the travel (1 - (1 - x)^2)
+  PEDAL_CURVE_COUNT
+} pedal_curve;
+
+// Input report: all axes 0..65535, steering centered at 32768
+typedef struct TU_ATTR_PACKED
+{
+  uint16_t steering;
+  uint16_t accelerator;
+  uint16_t brake;
+  uint16_t clutch;
+  uint32_t buttons;
+} hid_wheel_report_t;
+
+#define WHEEL_STEERING_CENTER 0x8000
+
+void wheel_init(void);
+void wheel_update_report(hid_wheel_report_t *report);
+void wheel_set_lock(uint16_t degrees);
+void wheel_recenter(void);
+bool wheel_set_pedal(uint8_t pedal, uint16_t rest, uint16_t full, uint8_t curve);
+uint16_t wheel_telemetry(uint8_t *buf, uint16_t len);
+
+#endif /* WHEEL_H_ */